@@ -0,0 +1,156 @@
+#include "AllocCount.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+static std::atomic<long long> alloc_count(0);
+static std::atomic<long long> free_count(0);
+static std::atomic<long long> alloc_bytes(0);
+static std::atomic<long long> live_bytes(0);
+static std::atomic<long long> peak_live_bytes(0);
+static std::atomic<long long> baseline_bytes(0);
+
+
+#ifdef LS_ALLOC_COUNT
+
+// Every block starts with its size, so that operator delete knows how many bytes are freed.
+// 16 bytes keep the alignment malloc gives to the block.
+static const size_t ALLOC_HEADER = 16;
+
+static void* counted_alloc(size_t size)
+{
+	void* base = std::malloc(size + ALLOC_HEADER);
+	if (base == nullptr)
+		return nullptr;
+
+	*static_cast<size_t*>(base) = size;
+
+	alloc_count.fetch_add(1, std::memory_order_relaxed);
+	alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+	long long live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+	long long peak = peak_live_bytes.load(std::memory_order_relaxed);
+	while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		;
+
+	return static_cast<char*>(base) + ALLOC_HEADER;
+}
+
+static void counted_free(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	void* base = static_cast<char*>(ptr) - ALLOC_HEADER;
+
+	free_count.fetch_add(1, std::memory_order_relaxed);
+	live_bytes.fetch_sub(*static_cast<size_t*>(base), std::memory_order_relaxed);
+
+	std::free(base);
+}
+
+void* operator new(size_t size)
+{
+	void* ptr = counted_alloc(size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](size_t size)
+{
+	void* ptr = counted_alloc(size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+
+#endif
+
+
+void alloc_reset()
+{
+#if defined(LS_ALLOC_COUNT) && defined(__linux__)
+	// "5" resets the peak RSS (VmHWM) of the process to its current RSS
+	{
+		ofstream clear_refs("/proc/self/clear_refs");
+		if (clear_refs.is_open())
+			clear_refs << "5";
+	}
+#endif
+
+	alloc_count.store(0);
+	free_count.store(0);
+	alloc_bytes.store(0);
+	baseline_bytes.store(live_bytes.load());
+	peak_live_bytes.store(live_bytes.load());
+}
+
+AllocStats alloc_stats()
+{
+	AllocStats s;
+	s.allocations = alloc_count.load();
+	s.frees = free_count.load();
+	s.bytes = alloc_bytes.load();
+	s.peak_bytes = peak_live_bytes.load() - baseline_bytes.load();
+	return s;
+}
+
+long long peak_rss_kb()
+{
+#ifdef __linux__
+	ifstream status("/proc/self/status");
+	string line;
+	while (getline(status, line))
+		if (line.rfind("VmHWM:", 0) == 0)
+			return std::atoll(line.c_str() + 6);
+#endif
+
+#ifndef _WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+		return usage.ru_maxrss / 1024;	//bytes on macOS
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+#endif
+
+	return -1;
+}
+
+std::vector<std::pair<std::string, std::string>> alloc_columns()
+{
+	std::vector<std::pair<std::string, std::string>> columns;
+
+#ifdef LS_ALLOC_COUNT
+	AllocStats s = alloc_stats();
+
+	columns.push_back(std::make_pair("Allocations", to_string(s.allocations)));
+	columns.push_back(std::make_pair("Frees", to_string(s.frees)));
+	columns.push_back(std::make_pair("Alloc_Bytes", to_string(s.bytes)));
+	columns.push_back(std::make_pair("Peak_Heap_Bytes", to_string(s.peak_bytes)));
+	columns.push_back(std::make_pair("Peak_RSS_KB", to_string(peak_rss_kb())));
+#endif
+
+	return columns;
+}
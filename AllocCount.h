@@ -0,0 +1,28 @@
+#pragma once
+
+// Heap allocations and peak memory per DFG, written as extra CSV columns.
+// The counting operator new/delete replacements of AllocCount.cpp are only compiled with -DLS_ALLOC_COUNT
+// (./run_code.bash run --alloc-count); otherwise nothing is replaced and alloc_columns() is empty.
+
+#include <string>
+#include <utility>
+#include <vector>
+
+struct AllocStats
+{
+	long long allocations = 0;	// operator new calls
+	long long frees = 0;		// operator delete calls
+	long long bytes = 0;		// bytes requested
+	long long peak_bytes = 0;	// max live heap bytes above the level at alloc_reset()
+};
+
+// Clears the counters (the live heap at this point is the baseline of the peak) and, where the OS allows it,
+// the peak RSS of the process
+void alloc_reset();
+AllocStats alloc_stats();
+
+// Peak resident set size in KB since alloc_reset() (Linux) or since the start of the process; -1 if unknown
+long long peak_rss_kb();
+
+// (header, value) pairs appended after Runtime_ms in the CSV files
+std::vector<std::pair<std::string, std::string>> alloc_columns();
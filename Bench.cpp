@@ -0,0 +1,457 @@
+// Microbenchmarks of the scheduler kernels.
+//
+// Usage: bench [options] [extra DFG files or directories]
+//   --repeats=N        timed samples per kernel (default 15)
+//   --warmup=W         untimed runs before the samples (default 2)
+//   --type=T           constraints file used: uniform (default) or invdelay
+//   --scale=X          resource constraints scaling factor (default 1.0)
+//   --kernels=a,b,...  only run these kernels (default: all)
+//   --max-fds=N        skip FDS above N nodes (default 1000, FDS takes seconds per run above ~1500 nodes)
+//   --max-outer=N      skip LS_outer_loop above N nodes (default 2500, covers every DFG of DFG/)
+//   --fds-threads=N    threads evaluating the FDS candidates (default 1, 0 = one per core)
+//   --fds-lookahead=N  depth of the predecessors / successors in the FDS forces (default 1)
+//   --fds-probes=N     LCs evaluated per round by FDS_Outer_Loop_bisect (default 1: plain bisection)
+//   --no-builtin       do not measure the DFGs of DFG/, only the given ones
+//   --out=FILE         JSON output (default bench.json)
+//   --compare=FILE     print the median ratio against a previous JSON output
+//
+// Every .txt DFG in DFG/ is measured, then the extra files/directories given on the command line
+// (e.g. DFGs written by dfggen). Each sample is the mean time of a batch of calls, the batch being
+// sized once so that a sample lasts at least 200 us. The JSON has one record per (DFG, kernel)
+// line so that two outputs can be diffed directly.
+//
+// Built with -DFDS_CHECK_FORCE, FDS() also computes every force with the reference loops and the
+// number of candidates whose closed-form force differs is printed at the end (exit status 1 if any).
+
+#include "LS.h"
+#include "LowerBound.h"
+#include "Stats.h"
+#include "Verify.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+
+using namespace std;
+
+double latencyParameter = 1.5;	//latency constant parameter, as in LSMain.cpp
+
+void ASAP(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay);
+void ALAP(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC);
+void getLC(int& LC, double& latency_parameter, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay);
+void calculate_fds_graphs(const DFGGraph& graph, const std::vector<NodeState>& state, std::vector<std::vector<float>>& fds_graphs, int target_latency, const std::vector<int>& delay, bool debug);
+void calculate_first_priority(std::vector<std::pair<int, NodeState*>>& available_ops, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, bool debug, bool featP, bool featS);
+float get_stiffness(int nodeId, const DFGGraph& graph, std::vector<int>& delay, std::vector<float>& memo);
+void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP);
+void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool featS, bool featP);
+void FDS(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC, double& latency_parameter, int tnum, bool debug, int threads, int lookahead);
+bool FDS_Outer_Loop(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC, double& latencyParameter, std::vector<int>& res_constr, bool debug, int threads, int lookahead, bool bisect, int probes, int& fds_runs);
+
+#ifdef FDS_CHECK_FORCE
+extern std::atomic<long long> fds_force_checks, fds_force_mismatches;
+#endif
+
+
+struct BenchConfig
+{
+	int repeats = 15;
+	int warmup = 2;
+	string data_type = "uniform";
+	double scale = 1.0;
+	set<string> kernels;		//empty = all
+	int max_fds = 1000;
+	int max_outer = 2500;
+	int fds_threads = 1;
+	int fds_lookahead = 1;
+	int fds_probes = 1;
+	string out_file = "bench.json";
+	string compare_file;
+	bool builtin = true;		//measure the DFGs of DFG/
+};
+
+struct BenchRecord
+{
+	string dfg;
+	int nodes = 0;
+	int edges = 0;
+	string kernel;
+	int batch = 0;				//calls per sample
+	SampleStats us;				//microseconds per call
+};
+
+
+// Time job: warmup runs, one batch size, then config.repeats samples of the mean time per call
+static BenchRecord time_kernel(const string& dfg, int nodes, int edges, const string& kernel, const BenchConfig& config, const std::function<void()>& job)
+{
+	using clock = std::chrono::steady_clock;
+
+	for (int i = 0; i < config.warmup; i++)
+		job();
+
+	auto t0 = clock::now();
+	job();
+	double once = std::chrono::duration<double, std::micro>(clock::now() - t0).count();
+
+	int batch = (once >= 200.0) ? 1 : static_cast<int>(std::min(10000.0, std::ceil(200.0 / std::max(once, 0.01))));
+
+	vector<double> samples;
+	for (int r = 0; r < config.repeats; r++) {
+		auto start = clock::now();
+		for (int b = 0; b < batch; b++)
+			job();
+		samples.push_back(std::chrono::duration<double, std::micro>(clock::now() - start).count() / batch);
+	}
+
+	BenchRecord rec;
+	rec.dfg = dfg;
+	rec.nodes = nodes;
+	rec.edges = edges;
+	rec.kernel = kernel;
+	rec.batch = batch;
+	rec.us = summarize(samples);
+
+	cout << "  " << std::left << std::setw(26) << kernel << std::right << " median " << std::setw(12) << std::fixed << std::setprecision(2) << rec.us.median
+		<< " us  p95 " << std::setw(12) << rec.us.p95 << " us  (batch " << batch << ")" << endl;
+
+	return rec;
+}
+
+// Resource constraints: the constraints file entry of the DFG, otherwise (generated or custom DFGs)
+// the average # of ops of each type running per cc of the ASAP schedule
+static vector<int> bench_constraints(const string& clean_name, std::map<string, ConstraintData>& db, const DFGGraph& graph, std::vector<int>& delay, double scale)
+{
+	vector<int> rc;
+
+	if (db.count(clean_name))
+		rc = db[clean_name].resources;
+	else {
+		vector<NodeState> state(graph.opn);
+		ASAP(graph, state, delay);
+		int latency = 1;
+		vector<long long> work(delay.size(), 0);
+		for (int id = 0; id < graph.opn; id++) {
+			latency = std::max(latency, state[id].asap + delay[graph.type[id]] - 1);
+			work[graph.type[id]] += delay[graph.type[id]];
+		}
+		for (size_t t = 0; t < delay.size(); t++)
+			rc.push_back(static_cast<int>(std::max(1LL, work[t] / latency)));
+	}
+
+	rc.resize(delay.size(), 1);
+	for (auto& r : rc) {
+		r = static_cast<int>(r * scale);
+		if (r < 1) r = 1;
+	}
+
+	return rc;
+}
+
+static void bench_dfg(string filename, const BenchConfig& config, std::map<string, ConstraintData>& db, std::vector<int>& delay, std::vector<string>& res_type, vector<BenchRecord>& records)
+{
+	std::map<int, G_Node> ops;
+	int edge_num = 0;
+	int opn = 0;
+
+	// records are keyed by file name (a DFG may exist both as .txt and .dfgb)
+	string dfg = std::filesystem::path(filename).filename().string();
+	if (std::filesystem::path(filename).extension() == ".dfgb") {
+		if (!readGraphInfoBinary(filename, edge_num, opn, ops))
+			return;
+	} else
+		readGraphInfo(filename, edge_num, opn, ops);
+
+	DFGGraph graph;
+	BuildGraph(ops, graph);
+
+	string clean_name = std::filesystem::path(filename).stem().string();
+	clean_name = clean_name.substr(0, clean_name.find("_4type"));
+	vector<int> res_constr = bench_constraints(clean_name, db, graph, delay, config.scale);
+
+	cout << dfg << " (" << opn << " ops, " << edge_num << " edges)" << endl;
+
+	auto wanted = [&](const string& kernel) { return config.kernels.empty() || config.kernels.count(kernel); };
+	auto run = [&](const string& kernel, const std::function<void()>& job) {
+		if (wanted(kernel))
+			records.push_back(time_kernel(dfg, opn, edge_num, kernel, config, job));
+	};
+
+	// Kernel inputs are prepared as LS() prepares them: ASAP, LC = latencyParameter * ASAP latency, ALAP
+	int latencyConstraint = 0;
+	vector<NodeState> state(opn);
+	ASAP(graph, state, delay);
+	getLC(latencyConstraint, latencyParameter, graph, state, delay);
+	ALAP(graph, state, delay, latencyConstraint);
+
+	run("ASAP", [&]() { ASAP(graph, state, delay); });
+	run("ALAP", [&]() { ALAP(graph, state, delay, latencyConstraint); });
+	run("latency_lower_bound", [&]() { latency_lower_bound(graph, delay, res_constr); });
+
+	int target_latency = 1;
+	for (int id = 0; id < opn; id++)
+		target_latency = std::max(target_latency, state[id].alap + delay[graph.type[id]] - 1);
+	vector<vector<float>> fds_graphs(delay.size(), vector<float>(target_latency + 2, 0.0f));
+
+	run("calculate_fds_graphs", [&]() { calculate_fds_graphs(graph, state, fds_graphs, target_latency, delay, false); });
+
+	// Candidates of the first cycle: the ops without parents
+	vector<pair<int, NodeState*>> available_ops;
+	for (int id = 0; id < opn; id++)
+		if (graph.parents(id).empty())
+			available_ops.push_back(make_pair(id, &state[id]));
+
+	run("calculate_first_priority", [&]() {
+		vector<pair<int, NodeState*>> candidates = available_ops;
+		calculate_first_priority(candidates, graph, state, delay, false, true, true);
+	});
+
+	run("get_stiffness", [&]() {
+		std::vector<float> memo(opn, -1.0f);
+		for (int i = 0; i < opn; i++)
+			get_stiffness(i, graph, delay, memo);
+	});
+
+	std::map<int, int> schlResult, FUAllocationResult;
+	std::map<int, std::map<int, std::vector<int>>> bindingResult;
+	int actualLatency = 0;
+
+	run("LS", [&]() {
+		int lc = 0;
+		LS(schlResult, FUAllocationResult, bindingResult, actualLatency, graph, lc, latencyParameter, delay, res_constr, false, false, false, false);
+	});
+
+	if (opn <= config.max_outer)
+		run("LS_outer_loop", [&]() {
+			int lc = 0;
+			LS_outer_loop(schlResult, FUAllocationResult, bindingResult, actualLatency, graph, lc, latencyParameter, delay, res_constr, false, true, true);
+		});
+	else if (wanted("LS_outer_loop"))
+		cout << "  LS_outer_loop skipped (" << opn << " ops > --max-outer)" << endl;
+
+	if (opn <= config.max_fds)
+		run("FDS", [&]() {
+			int lc = 0;
+			vector<NodeState> fds_state;
+			FDS(graph, fds_state, delay, lc, latencyParameter, delay.size(), false, config.fds_threads, config.fds_lookahead);
+		});
+	else if (wanted("FDS"))
+		cout << "  FDS skipped (" << opn << " ops > --max-fds)" << endl;
+
+	// Search of the LC meeting the resource constraints: +3 steps and bisection
+	for (bool bisect : { false, true }) {
+		string kernel = bisect ? "FDS_Outer_Loop_bisect" : "FDS_Outer_Loop";
+		if (opn > config.max_fds) {
+			if (wanted(kernel))
+				cout << "  " << kernel << " skipped (" << opn << " ops > --max-fds)" << endl;
+			continue;
+		}
+
+		int lc = 0, fds_runs = 0;
+		bool feasible = false;
+		run(kernel, [&]() {
+			lc = 0;
+			vector<NodeState> fds_state;
+			feasible = FDS_Outer_Loop(graph, fds_state, delay, lc, latencyParameter, res_constr, false, config.fds_threads,
+				config.fds_lookahead, bisect, config.fds_probes, fds_runs);
+		});
+		if (wanted(kernel))
+			cout << "  " << kernel << ": " << (feasible ? "LC " : "no feasible LC, last ") << lc << ", " << fds_runs << " FDS runs" << endl;
+	}
+
+	// Checker validation of the base LS schedule, as the checker sees it
+	if (wanted("verify_schedule")) {
+		int lc = 0;
+		LS(schlResult, FUAllocationResult, bindingResult, actualLatency, graph, lc, latencyParameter, delay, res_constr, false, false, false, false);
+
+		vector<int> op_type, start(opn), fu(opn);
+		vector<pair<int, int>> edges;
+		flatten_graph(ops, opn, op_type, edges);
+
+		std::map<int, string> FU_type;
+		std::map<int, int> rc, reported_FUs;
+		int curr_idx = 0;
+		for (int t = 0; t < static_cast<int>(delay.size()); t++) {
+			FU_type[t] = res_type[t];
+			rc[t] = res_constr[t];
+			reported_FUs[t] = 0;
+			for (int f = 0; f < FUAllocationResult[t]; f++) {
+				if (!bindingResult[t][f].empty())
+					reported_FUs[t]++;
+				for (int op : bindingResult[t][f])
+					fu[op] = curr_idx + f;
+			}
+			curr_idx += FUAllocationResult[t];
+		}
+		for (int i = 0; i < opn; i++)
+			start[i] = schlResult[i];
+
+		run("verify_schedule", [&]() {
+			VerifyReport report;
+			verify_schedule(op_type, edges, start, fu, delay, FU_type, rc, reported_FUs, actualLatency, false, report);
+		});
+	}
+}
+
+static string json_escape(const string& s)
+{
+	string out;
+	for (char c : s) {
+		if (c == '"' || c == '\\')
+			out += '\\';
+		out += c;
+	}
+	return out;
+}
+
+static void write_json(const string& filename, const BenchConfig& config, const vector<BenchRecord>& records)
+{
+	ofstream out(filename, ios::out);
+	if (!out.is_open()) {
+		cerr << "Error: cannot write " << filename << endl;
+		return;
+	}
+
+	out << std::fixed << std::setprecision(3);
+	out << "{" << endl;
+	out << "  \"compiler\": \"" << json_escape(__VERSION__) << "\"," << endl;
+	out << "  \"repeats\": " << config.repeats << ", \"warmup\": " << config.warmup << ", \"type\": \"" << config.data_type
+		<< "\", \"scale\": " << config.scale << "," << endl;
+	out << "  \"results\": [" << endl;
+
+	for (size_t i = 0; i < records.size(); i++) {
+		const BenchRecord& r = records[i];
+		out << "    {\"dfg\": \"" << json_escape(r.dfg) << "\", \"kernel\": \"" << r.kernel << "\", \"nodes\": " << r.nodes << ", \"edges\": " << r.edges
+			<< ", \"batch\": " << r.batch << ", \"samples\": " << r.us.count << ", \"min_us\": " << r.us.min << ", \"median_us\": " << r.us.median
+			<< ", \"p95_us\": " << r.us.p95 << ", \"mean_us\": " << r.us.mean << ", \"stddev_us\": " << r.us.stddev << "}"
+			<< (i + 1 < records.size() ? "," : "") << endl;
+	}
+
+	out << "  ]" << endl;
+	out << "}" << endl;
+}
+
+// Value of "key": in one record line of our own JSON output
+static string json_field(const string& line, const string& key)
+{
+	string pattern = "\"" + key + "\": ";
+	size_t pos = line.find(pattern);
+	if (pos == string::npos)
+		return "";
+	pos += pattern.size();
+
+	if (line[pos] == '"') {
+		size_t end = line.find('"', pos + 1);
+		return line.substr(pos + 1, end - pos - 1);
+	}
+	return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+static void compare_json(const string& filename, const vector<BenchRecord>& records)
+{
+	ifstream in(filename);
+	if (!in.is_open()) {
+		cerr << "Error: cannot open " << filename << endl;
+		return;
+	}
+
+	std::map<pair<string, string>, double> before;
+	string line;
+	while (getline(in, line)) {
+		string dfg = json_field(line, "dfg"), kernel = json_field(line, "kernel"), median = json_field(line, "median_us");
+		if (!dfg.empty() && !kernel.empty() && !median.empty())
+			before[make_pair(dfg, kernel)] = std::stod(median);
+	}
+
+	cout << endl << "Median time vs " << filename << " (ratio < 1 is faster):" << endl;
+	for (const auto& r : records) {
+		auto it = before.find(make_pair(r.dfg, r.kernel));
+		if (it == before.end() || it->second <= 0)
+			continue;
+		cout << "  " << std::left << std::setw(50) << r.dfg << std::setw(26) << r.kernel << std::right
+			<< std::setw(12) << it->second << " -> " << std::setw(12) << r.us.median << "  x" << std::setprecision(3) << r.us.median / it->second
+			<< std::setprecision(2) << endl;
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	BenchConfig config;
+	vector<string> inputs;
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+
+		if (arg.rfind("--repeats=", 0) == 0)			config.repeats = std::max(1, std::stoi(arg.substr(10)));
+		else if (arg.rfind("--warmup=", 0) == 0)		config.warmup = std::max(0, std::stoi(arg.substr(9)));
+		else if (arg.rfind("--type=", 0) == 0)			config.data_type = arg.substr(7);
+		else if (arg.rfind("--scale=", 0) == 0)			config.scale = std::stod(arg.substr(8));
+		else if (arg.rfind("--max-fds=", 0) == 0)		config.max_fds = std::stoi(arg.substr(10));
+		else if (arg.rfind("--max-outer=", 0) == 0)		config.max_outer = std::stoi(arg.substr(12));
+		else if (arg.rfind("--fds-threads=", 0) == 0)	config.fds_threads = std::stoi(arg.substr(14));
+		else if (arg.rfind("--fds-lookahead=", 0) == 0)	config.fds_lookahead = std::max(0, std::stoi(arg.substr(16)));
+		else if (arg.rfind("--fds-probes=", 0) == 0)	config.fds_probes = std::max(1, std::stoi(arg.substr(13)));
+		else if (arg.rfind("--out=", 0) == 0)			config.out_file = arg.substr(6);
+		else if (arg.rfind("--compare=", 0) == 0)		config.compare_file = arg.substr(10);
+		else if (arg == "--no-builtin")					config.builtin = false;
+		else if (arg.rfind("--kernels=", 0) == 0) {
+			stringstream ss(arg.substr(10));
+			string kernel;
+			while (getline(ss, kernel, ','))
+				config.kernels.insert(kernel);
+		}
+		else if (arg.rfind("--", 0) == 0)
+			cerr << "Warning: unknown option " << arg << " ignored." << endl;
+		else
+			inputs.push_back(arg);
+	}
+
+	std::vector<int> delay, lp, dp;
+	std::vector<string> res_type;
+	READ_LIB("lib_4type.txt", delay, lp, dp, res_type);
+
+	std::map<string, ConstraintData> db;
+	LoadConstraints("Constraints/constraints_" + config.data_type + ".txt", db);
+
+	// DFG/ first (sorted), then the extra inputs in the given order
+	vector<string> files;
+	auto add_dir = [&files](const string& dir) {
+		vector<string> found;
+		for (const auto& entry : std::filesystem::directory_iterator(dir))
+			if (entry.is_regular_file() && (entry.path().extension() == ".txt" || entry.path().extension() == ".dfgb"))
+				found.push_back(entry.path().string());
+		std::sort(found.begin(), found.end());
+		files.insert(files.end(), found.begin(), found.end());
+	};
+
+	if (config.builtin && std::filesystem::is_directory("DFG"))
+		add_dir("DFG");
+	for (const auto& input : inputs) {
+		if (std::filesystem::is_directory(input))
+			add_dir(input);
+		else if (std::filesystem::exists(input))
+			files.push_back(input);
+		else
+			cerr << "Warning: " << input << " not found." << endl;
+	}
+
+	vector<BenchRecord> records;
+	for (auto& file : files)
+		bench_dfg(file, config, db, delay, res_type, records);
+
+	write_json(config.out_file, config, records);
+	cout << endl << records.size() << " measurements written to " << config.out_file << endl;
+
+	if (!config.compare_file.empty())
+		compare_json(config.compare_file, records);
+
+#ifdef FDS_CHECK_FORCE
+	cout << "FDS force check: " << fds_force_mismatches << " mismatches in " << fds_force_checks << " candidates" << endl;
+	if (fds_force_mismatches > 0)
+		return 1;
+#endif
+
+	return 0;
+}
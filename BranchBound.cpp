@@ -0,0 +1,501 @@
+#include "BranchBound.h"
+#include "LowerBound.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "Perf.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <deque>
+#include <iostream>
+#include <mutex>
+
+using namespace std;
+
+// Subproblems cut per thread at the top of the tree, so that the threads stay busy until the end
+#define BB_SUBPROBLEMS_PER_THREAD 16
+// Nodes visited between two looks at the clock
+#define BB_CHECK_INTERVAL 1024
+
+void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP);
+void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool featS, bool featP);
+void FDS_Binding(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay,
+	std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult,
+	int& actualLatency);
+
+
+// Read-only data of the search, shared by the threads
+struct BBProblem
+{
+	const DFGGraph* graph;
+	const vector<int>* delay;
+	const vector<int>* res_constr;
+	vector<int> order;		// topological order
+	vector<int> tail;		// cycles of dependent work after each op ends
+	vector<int> by_rank;	// order in which the ops of a cycle are started: largest tail first
+	vector<int> rank;		// position of each op in by_rank
+};
+
+// Incumbent and clock, shared by the threads
+struct BBShared
+{
+	std::atomic<int> best{INT_MAX};
+	std::mutex mutex;
+	vector<int> best_start;
+	bool limited = false;
+	std::chrono::steady_clock::time_point deadline;
+	std::atomic<bool> stop{false};
+	bool debug = false;
+};
+
+// Edge from a node to a child: start op at the current cycle, or (op = -1) move on to cycle cc
+struct BBStep
+{
+	int op;
+	int cc;
+};
+
+// One partial schedule, changed in place: every change goes on the trail and is undone on the way back up
+class BBSearch
+{
+public:
+	BBSearch(const BBProblem& problem, BBShared& shared);
+
+	void reset() { undo(0); }
+	void apply(const BBStep& step);
+	bool complete() const { return scheduled == opn; }
+	int bound();
+	void children(vector<BBStep>& steps) const;
+	void offer();
+	bool dfs();		//false: stopped (time budget, cancellation), the subtree is not searched to the end
+
+	long long nodes = 0;
+
+private:
+	const BBProblem& problem;
+	BBShared& shared;
+	const DFGGraph& graph;
+	const vector<int>& delay;
+	int opn;
+
+	int t = 1;				// current cycle
+	int min_rank = 0;		// the ops started at t from now on come after this rank
+	int scheduled = 0;
+	int finish = 0;			// last busy cycle of the ops started
+	vector<int> start;		// start cycle, -1 if not started
+	vector<int> ready;		// first cycle allowed by the predecessors started
+	vector<int> waiting;	// # of predecessors not started
+	vector<vector<int>> free_at;	// per type and FU, first cycle at which it is free
+
+	vector<pair<int*, int>> trail;
+	vector<int> est, first_free, count, min_est, min_tail;		// bound() scratch
+
+	void set(int& slot, int value)
+	{
+		trail.push_back(make_pair(&slot, slot));
+		slot = value;
+	}
+	void undo(size_t mark)
+	{
+		for (; trail.size() > mark; trail.pop_back())
+			*trail.back().first = trail.back().second;
+	}
+
+	bool can_start(int op) const;
+	int next_event() const;
+	void place(int op);
+};
+
+BBSearch::BBSearch(const BBProblem& problem, BBShared& shared)
+	: problem(problem), shared(shared), graph(*problem.graph), delay(*problem.delay), opn(problem.graph->opn)
+{
+	start.assign(opn, -1);
+	ready.assign(opn, 1);
+	waiting.resize(opn);
+	for (int op = 0; op < opn; op++)
+		waiting[op] = graph.parents(op).size();
+
+	free_at.resize(delay.size());
+	for (size_t type = 0; type < delay.size(); type++)
+		free_at[type].assign((*problem.res_constr)[type], 1);
+
+	est.resize(opn);
+	first_free.resize(delay.size());
+	count.resize(delay.size());
+	min_est.resize(delay.size());
+	min_tail.resize(delay.size());
+}
+
+bool BBSearch::can_start(int op) const
+{
+	if (start[op] >= 0 || waiting[op] > 0 || ready[op] > t)
+		return false;
+
+	for (int free : free_at[graph.type[op]])
+		if (free <= t)
+			return true;
+	return false;
+}
+
+// Next cycle at which an FU frees up or a waiting op becomes ready: an op starting between two of them could start
+// earlier, so the schedules with such starts are left out
+int BBSearch::next_event() const
+{
+	int cc = INT_MAX;
+	for (const vector<int>& fus : free_at)
+		for (int free : fus)
+			if (free > t)
+				cc = std::min(cc, free);
+
+	for (int op = 0; op < opn; op++)
+		if (start[op] < 0 && waiting[op] == 0 && ready[op] > t)
+			cc = std::min(cc, ready[op]);
+	return cc;
+}
+
+void BBSearch::place(int op)
+{
+	int type = graph.type[op], d = delay[type];
+
+	for (int& free : free_at[type])
+		if (free <= t) {
+			set(free, t + d);
+			break;
+		}
+
+	set(start[op], t);
+	set(scheduled, scheduled + 1);
+	set(finish, std::max(finish, t + d - 1));
+	set(min_rank, problem.rank[op] + 1);
+
+	for (int su : graph.children(op)) {
+		set(ready[su], std::max(ready[su], t + d));
+		set(waiting[su], waiting[su] - 1);
+	}
+}
+
+void BBSearch::apply(const BBStep& step)
+{
+	if (step.op >= 0)
+		place(step.op);
+	else {
+		set(t, step.cc);
+		set(min_rank, 0);
+	}
+}
+
+void BBSearch::children(vector<BBStep>& steps) const
+{
+	steps.clear();
+	for (int r = min_rank; r < opn; r++)
+		if (can_start(problem.by_rank[r]))
+			steps.push_back({ problem.by_rank[r], t });
+
+	int cc = next_event();
+	if (cc != INT_MAX)
+		steps.push_back({ -1, cc });
+}
+
+// Lower bound of the latency of every schedule below this node
+int BBSearch::bound()
+{
+	int tnum = delay.size();
+	int lb = finish;
+
+	for (int type = 0; type < tnum; type++) {
+		first_free[type] = INT_MAX;
+		for (int free : free_at[type])
+			first_free[type] = std::min(first_free[type], free);
+		count[type] = 0;
+		min_est[type] = min_tail[type] = INT_MAX;
+	}
+
+	// earliest start of the ops not started: the current cycle (the next one for the ops that can no longer start
+	// in it), their predecessors, the first FU of their type to free up
+	for (int op = 0; op < opn; op++)
+		est[op] = 0;
+
+	for (int op : problem.order) {
+		if (start[op] >= 0)
+			continue;
+
+		int type = graph.type[op];
+		int e = std::max({ est[op], ready[op], t, first_free[type] });
+		if (e == t && problem.rank[op] < min_rank)
+			e = t + 1;
+
+		lb = std::max(lb, e + delay[type] - 1 + problem.tail[op]);
+		for (int su : graph.children(op))
+			est[su] = std::max(est[su], e + delay[type]);
+
+		count[type]++;
+		min_est[type] = std::min(min_est[type], e);
+		min_tail[type] = std::min(min_tail[type], problem.tail[op]);
+	}
+
+	// the ops of a type left start at min_est or later, each FU from the cycle it frees up, and are followed by
+	// min_tail cycles at least: smallest last cycle E of the FUs at which they all fit
+	for (int type = 0; type < tnum; type++) {
+		if (count[type] == 0)
+			continue;
+
+		int d = delay[type];
+		auto fits = [&](int E) {
+			long long ops = 0;
+			for (int free : free_at[type]) {
+				int from = std::max(min_est[type], free);
+				if (E >= from)
+					ops += (E - from + 1) / d;
+			}
+			return ops >= count[type];
+		};
+
+		int low = min_est[type] + d - 1, high = low;
+		for (int free : free_at[type])
+			high = std::max(high, std::max(min_est[type], free) + count[type] * d - 1);
+		while (low < high) {
+			int mid = low + (high - low) / 2;
+			if (fits(mid))
+				high = mid;
+			else
+				low = mid + 1;
+		}
+
+		lb = std::max(lb, low + min_tail[type]);
+	}
+
+	return lb;
+}
+
+void BBSearch::offer()
+{
+	if (finish >= shared.best.load())
+		return;
+
+	lock_guard<mutex> lock(shared.mutex);
+	if (finish < shared.best.load()) {
+		shared.best.store(finish);
+		shared.best_start = start;
+		if (shared.debug)
+			cout << "[BB] new incumbent with latency " << finish << endl;
+	}
+}
+
+bool BBSearch::dfs()
+{
+	if (++nodes % BB_CHECK_INTERVAL == 0
+		&& ((shared.limited && std::chrono::steady_clock::now() > shared.deadline) || schedule_cancelled()))
+		shared.stop.store(true);
+	if (shared.stop.load(std::memory_order_relaxed))
+		return false;
+
+	if (complete()) {
+		offer();
+		return true;
+	}
+
+	if (bound() >= shared.best.load(std::memory_order_relaxed))
+		return true;
+
+	for (int r = min_rank; r < opn; r++) {
+		int op = problem.by_rank[r];
+		if (!can_start(op))
+			continue;
+
+		size_t mark = trail.size();
+		place(op);
+		bool go_on = dfs();
+		undo(mark);
+		if (!go_on)
+			return false;
+	}
+
+	int cc = next_event();
+	if (cc == INT_MAX)
+		return true;
+
+	size_t mark = trail.size();
+	set(t, cc);
+	set(min_rank, 0);
+	bool go_on = dfs();
+	undo(mark);
+	return go_on;
+}
+
+
+void BB_Schedule(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool ls_base, bool featS, bool featP,
+	int threads, int time_budget_ms, BBStats& stats)
+{
+	TRACE_SCOPE("BB_Schedule", "bb");
+
+	stats = BBStats();
+	int opn = graph.opn;
+
+	// the search indexes delay and res_constr by op type
+	for (int op = 0; op < opn; op++)
+		if (graph.type[op] < 0 || graph.type[op] >= static_cast<int>(std::min(delay.size(), res_constr.size()))) {
+			cerr << "Error: op " << op << " has the type " << graph.type[op] << ", which has no delay or resource constraint, no branch and bound." << endl;
+			actualLatency = 0;
+			return;
+		}
+
+	// initial incumbent
+	int latencyConstraint = 0;
+	if (ls_base)
+		LS(schlResult, FUAllocationResult, bindingResult, actualLatency,
+			graph, latencyConstraint, latencyParameter, delay, res_constr, false, debug, false, false);
+	else
+		LS_outer_loop(schlResult, FUAllocationResult, bindingResult, actualLatency,
+			graph, latencyConstraint, latencyParameter, delay, res_constr, debug, featS, featP);
+	stats.initial_latency = actualLatency;
+
+	LatencyBound root_bound = latency_lower_bound(graph, delay, res_constr);
+	stats.lower_bound = std::min(root_bound.latency, actualLatency);
+
+	for (int op = 0; op < opn; op++)
+		if (res_constr[graph.type[op]] <= 0) {
+			cerr << "Warning: no FU of the type of op " << op << ", no branch and bound." << endl;
+			return;
+		}
+
+	if (actualLatency > 0 && actualLatency <= root_bound.latency) {
+		stats.optimal = true;
+		return;
+	}
+
+	PERF_SCOPE(PERF_BB);
+	auto start_time = std::chrono::steady_clock::now();
+
+	BBProblem problem;
+	problem.graph = &graph;
+	problem.delay = &delay;
+	problem.res_constr = &res_constr;
+
+	vector<int> pending(opn);
+	for (int op = 0; op < opn; op++) {
+		pending[op] = graph.parents(op).size();
+		if (pending[op] == 0)
+			problem.order.push_back(op);
+	}
+	for (size_t k = 0; k < problem.order.size(); k++)
+		for (int su : graph.children(problem.order[k]))
+			if (--pending[su] == 0)
+				problem.order.push_back(su);
+
+	problem.tail.assign(opn, 0);
+	for (int k = opn - 1; k >= 0; k--) {
+		int op = problem.order[k];
+		for (int su : graph.children(op))
+			problem.tail[op] = std::max(problem.tail[op], delay[graph.type[su]] + problem.tail[su]);
+	}
+
+	problem.by_rank.resize(opn);
+	for (int op = 0; op < opn; op++)
+		problem.by_rank[op] = op;
+	std::stable_sort(problem.by_rank.begin(), problem.by_rank.end(), [&](int a, int b) {
+		return problem.tail[a] + delay[graph.type[a]] > problem.tail[b] + delay[graph.type[b]];
+	});
+	problem.rank.resize(opn);
+	for (int r = 0; r < opn; r++)
+		problem.rank[problem.by_rank[r]] = r;
+
+	BBShared shared;
+	shared.debug = debug;
+	if (actualLatency > 0) {
+		shared.best.store(actualLatency);
+		shared.best_start.assign(opn, 0);
+		for (int op = 0; op < opn; op++)
+			shared.best_start[op] = schlResult[op];
+	}
+	if (time_budget_ms > 0) {
+		shared.limited = true;
+		shared.deadline = start_time + std::chrono::milliseconds(time_budget_ms);
+	}
+
+	// Subproblems: the top of the tree, breadth first, down to enough nodes for the threads
+	if (threads <= 0)
+		threads = default_thread_count();
+
+	BBSearch root(problem, shared);
+	stats.lower_bound = std::min(std::max(root_bound.latency, root.bound()), shared.best.load());
+
+	deque<vector<BBStep>> open;
+	open.push_back(vector<BBStep>());
+	vector<BBStep> steps;
+	while (!open.empty() && open.size() < static_cast<size_t>(threads * BB_SUBPROBLEMS_PER_THREAD)) {
+		vector<BBStep> path = open.front();
+		open.pop_front();
+
+		root.reset();
+		for (const BBStep& step : path)
+			root.apply(step);
+		stats.nodes++;
+
+		if (root.complete()) {
+			root.offer();
+			continue;
+		}
+		if (root.bound() >= shared.best.load())
+			continue;
+
+		root.children(steps);
+		for (const BBStep& step : steps) {
+			open.push_back(path);
+			open.back().push_back(step);
+		}
+	}
+
+	vector<vector<BBStep>> subproblems(open.begin(), open.end());
+	int count = subproblems.size();
+	vector<int> sub_bound(count, 0);
+	vector<char> sub_finished(count, 0);
+	vector<long long> sub_nodes(count, 0);
+
+	const std::atomic<bool>* cancel = schedule_cancel;	//the workers follow the cancellation of the caller
+	parallel_for(count, threads, [&](int k) {
+		schedule_cancel = cancel;
+
+		BBSearch search(problem, shared);
+		for (const BBStep& step : subproblems[k])
+			search.apply(step);
+
+		sub_bound[k] = search.bound();
+		sub_finished[k] = search.dfs();
+		sub_nodes[k] = search.nodes;
+	});
+
+	// proven bound: the incumbent, unless a subproblem left open may hold a shorter schedule
+	int best = shared.best.load();
+	int proven = best;
+	stats.subproblems = count;
+	for (int k = 0; k < count; k++) {
+		stats.nodes += sub_nodes[k];
+		if (sub_finished[k])
+			stats.finished++;
+		else
+			proven = std::min(proven, sub_bound[k]);
+	}
+	stats.lower_bound = std::max(stats.lower_bound, proven);
+	stats.optimal = stats.lower_bound >= best;
+	stats.timed_out = shared.stop.load() && !stats.optimal;
+
+	std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start_time;
+	stats.search_ms = duration.count();
+
+	if (debug)
+		cout << "[BB] " << stats.nodes << " nodes, " << stats.finished << " of " << count << " subproblems searched, latency " << best
+			<< ", lower bound " << stats.lower_bound << endl;
+
+	// a shorter schedule than the LS one: bound to FUs as the FDS schedules are
+	if (best != INT_MAX && (best < stats.initial_latency || actualLatency <= 0)) {
+		vector<NodeState> state(opn);
+		for (int op = 0; op < opn; op++)
+			state[op].asap = shared.best_start[op];
+		FDS_Binding(graph, state, delay, schlResult, FUAllocationResult, bindingResult, actualLatency);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Anytime branch-and-bound scheduler (--engine=bb): looks for a schedule meeting the resource constraints with the
+// smallest latency, for small and medium DFGs. The LS schedule (base LS or LS_outer_loop, as selected) is the first
+// incumbent. The search builds schedules cycle by cycle: at cycle t it starts one more ready op on a free FU, or it
+// moves on to the next cycle at which an FU frees up or an op becomes ready. Schedules where an op could start earlier
+// are never built, one of the others is optimal. The ops started in the same cycle are taken in a fixed order, so a
+// set of starts is only built once. A node is pruned when its lower bound (critical path from the earliest starts,
+// and for every type its remaining ops spread over the FUs from the cycle each one frees up) is not below the
+// incumbent.
+//
+// The tree is cut into subproblems at its first levels, which the threads take one at a time, sharing the incumbent.
+// When the time budget runs out, the subproblems not searched to the end keep their bound: the smallest of them
+// (and of the incumbent) is a proven lower bound of the latency. With more than one thread, or a time budget that
+// runs out, which schedule is kept among the ones of the same latency depends on the timing.
+
+#include "LS.h"
+
+#include <map>
+#include <vector>
+
+struct BBStats
+{
+	int initial_latency = 0;		// latency of the LS schedule the search starts from
+	int lower_bound = 0;			// proven: no schedule meeting the constraints is shorter
+	bool optimal = false;			// the incumbent is at the lower bound
+	bool timed_out = false;			// the time budget ran out before the end of the search
+	long long nodes = 0;			// search nodes visited
+	int subproblems = 0;			// subproblems the threads searched, or would have
+	int finished = 0;				// subproblems searched to the end
+	double search_ms = 0;			// time of the search, without the LS run
+};
+
+// time_budget_ms <= 0: no limit. threads <= 0: one per core.
+void BB_Schedule(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool ls_base, bool featS, bool featP,
+	int threads, int time_budget_ms, BBStats& stats);
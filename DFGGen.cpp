@@ -0,0 +1,266 @@
+// Synthetic DFG generator: seeded layered random DAGs with the type mix of the "_4type_uniform" and
+// "_4type_invdelay" benchmark variants, for inputs much larger than the ones in DFG/.
+//
+// Usage: dfggen <name> <# of nodes> <uniform|invdelay> [options]
+//   --depth=D          # of layers (default: sqrt(# of nodes))
+//   --fanin=K          max # of parents of a node (default 2)
+//   --fanout=F         max # of children of a node (default 4)
+//   --span=L           parents are taken from the L previous layers (default 2)
+//   --seed=S           random seed (default 1)
+//   --out=DIR          output directory (default DFG)
+//   --binary           also write the binary format (<file>.dfgb, see readGraphInfoBinary)
+//   --constraints=FILE append the constraints line to FILE (it is always printed)
+//
+// The DFG is written as <DIR>/<name>_4type_<type>.txt in the usual text format. Nodes are written in
+// layer order and every node line is followed by the edges entering it, so the file is also valid
+// input for the streaming scheduler (--stream).
+//
+// The output only depends on the arguments: the random numbers come from std::mt19937_64, whose
+// sequence is fixed by the standard, and not from the (implementation defined) std distributions.
+
+#include "LS.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+
+using namespace std;
+
+
+// Uniform integer in [0, n)
+static uint64_t rand_below(std::mt19937_64& rng, uint64_t n)
+{
+	return rng() % n;
+}
+
+// Exact # of nodes of each type: largest remainder of N * weight
+static vector<int> type_quota(int N, const vector<double>& weight)
+{
+	int numberOfFunctionType = weight.size();
+	double total = 0;
+	for (double w : weight)
+		total += w;
+
+	vector<int> count(numberOfFunctionType);
+	vector<pair<double, int>> remainder;
+	int assigned = 0;
+
+	for (int t = 0; t < numberOfFunctionType; t++) {
+		double exact = N * weight[t] / total;
+		count[t] = static_cast<int>(exact);
+		assigned += count[t];
+		remainder.push_back(make_pair(-(exact - count[t]), t));
+	}
+
+	sort(remainder.begin(), remainder.end());
+	for (int i = 0; assigned < N; i++, assigned++)
+		count[remainder[i % numberOfFunctionType].second]++;
+
+	return count;
+}
+
+static void put_u32(ofstream& out, uint32_t v)
+{
+	char b[4] = { char(v & 0xff), char((v >> 8) & 0xff), char((v >> 16) & 0xff), char((v >> 24) & 0xff) };
+	out.write(b, 4);
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 4) {
+		cerr << "Usage: " << argv[0] << " <name> <# of nodes> <uniform|invdelay> [--depth=D] [--fanin=K] [--fanout=F] [--span=L]"
+			<< " [--seed=S] [--out=DIR] [--binary] [--constraints=FILE]" << endl;
+		return 1;
+	}
+
+	string name = argv[1];
+	int N = std::stoi(argv[2]);
+	string data_type = argv[3];
+
+	int depth = 0, fanin = 2, fanout = 4, span = 2;
+	uint64_t seed = 1;
+	string out_dir = "DFG";
+	string constraints_file;
+	bool binary = false;
+
+	for (int i = 4; i < argc; i++) {
+		string arg = argv[i];
+
+		if (arg.rfind("--depth=", 0) == 0)				depth = std::stoi(arg.substr(8));
+		else if (arg.rfind("--fanin=", 0) == 0)			fanin = std::stoi(arg.substr(8));
+		else if (arg.rfind("--fanout=", 0) == 0)		fanout = std::stoi(arg.substr(9));
+		else if (arg.rfind("--span=", 0) == 0)			span = std::stoi(arg.substr(7));
+		else if (arg.rfind("--seed=", 0) == 0)			seed = std::stoull(arg.substr(7));
+		else if (arg.rfind("--out=", 0) == 0)			out_dir = arg.substr(6);
+		else if (arg.rfind("--constraints=", 0) == 0)	constraints_file = arg.substr(14);
+		else if (arg == "--binary")						binary = true;
+		else
+			cerr << "Warning: unknown option " << arg << " ignored." << endl;
+	}
+
+	if (data_type != "uniform" && data_type != "invdelay") {
+		cerr << "Error: unknown type distribution " << data_type << " (uniform or invdelay)." << endl;
+		return 1;
+	}
+
+	if (N < 1 || fanin < 1 || fanout < 1 || span < 1) {
+		cerr << "Error: # of nodes, fan-in, fan-out and span must be positive." << endl;
+		return 1;
+	}
+
+	if (depth <= 0)
+		depth = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(N))));
+	depth = std::min(depth, N);
+
+	// FU types and delays from the library, as the scheduler sees them
+	std::vector<int> delay, lp, dp;
+	std::vector<string> res_type;
+	READ_LIB("lib_4type.txt", delay, lp, dp, res_type);
+
+	if (delay.empty()) {
+		cerr << "Error: no FU type read from lib_4type.txt" << endl;
+		return 1;
+	}
+
+	int numberOfFunctionType = delay.size();
+
+	// uniform: same # of nodes of each type; invdelay: # of nodes proportional to 1 / delay
+	vector<double> weight(numberOfFunctionType, 1.0);
+	if (data_type == "invdelay")
+		for (int t = 0; t < numberOfFunctionType; t++)
+			weight[t] = 1.0 / delay[t];
+
+	std::mt19937_64 rng(seed);
+
+	vector<int> count = type_quota(N, weight);
+	vector<int> type;
+	for (int t = 0; t < numberOfFunctionType; t++)
+		type.insert(type.end(), count[t], t);
+
+	for (int i = N - 1; i > 0; i--)
+		std::swap(type[i], type[rand_below(rng, i + 1)]);
+
+	// Layer l holds the nodes [layerStart[l], layerStart[l + 1])
+	vector<int> layerStart(depth + 1);
+	for (int l = 0; l <= depth; l++)
+		layerStart[l] = static_cast<int>(static_cast<int64_t>(N) * l / depth);
+
+	// Parents of each node, the first parent comes from the previous layer so that the depth is the requested one
+	vector<int> numChildren(N, 0);
+	vector<int> parentStart(N + 1, 0);
+	vector<int> parents;
+
+	for (int l = 0; l < depth; l++) {
+		for (int u = layerStart[l]; u < layerStart[l + 1]; u++) {
+			parentStart[u] = parents.size();
+
+			if (l > 0) {
+				int k = 1 + rand_below(rng, fanin);
+				int firstLayer = std::max(0, l - span);
+
+				for (int p = 0; p < k; p++) {
+					int from = (p == 0) ? layerStart[l - 1] : layerStart[firstLayer];
+					int range = layerStart[l] - from;
+
+					// a few tries to find a parent that is new and below the fan-out limit
+					for (int tries = 0; tries < 8; tries++) {
+						int pr = from + rand_below(rng, range);
+						bool dup = numChildren[pr] >= fanout;
+						for (int q = parentStart[u]; q < static_cast<int>(parents.size()) && !dup; q++)
+							dup = (parents[q] == pr);
+
+						if (!dup) {
+							parents.push_back(pr);
+							numChildren[pr]++;
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+	parentStart[N] = parents.size();
+
+	// Node names follow the benchmarks: <TYPE>_<i>
+	vector<string> typeName(numberOfFunctionType);
+	for (int t = 0; t < numberOfFunctionType; t++) {
+		typeName[t] = res_type[t];
+		std::transform(typeName[t].begin(), typeName[t].end(), typeName[t].begin(), ::toupper);
+	}
+
+	auto nodeName = [&](int u) { return typeName[type[u]] + "_" + to_string(u + 1); };
+
+	string dfg_file = out_dir + "/" + name + "_4type_" + data_type;
+
+	std::error_code ec;
+	std::filesystem::create_directories(out_dir, ec);
+
+	ofstream fout(dfg_file + ".txt", ios::out);
+	if (!fout.is_open()) {
+		cerr << "Error: cannot write " << dfg_file << ".txt" << endl;
+		return 1;
+	}
+
+	fout << "digraph " << name << " {\n";
+	int edge_num = 0;
+	for (int u = 0; u < N; u++) {
+		fout << "  " << nodeName(u) << " [label= " << typeName[type[u]] << " ];\n";
+		for (int q = parentStart[u]; q < parentStart[u + 1]; q++)
+			fout << "  " << nodeName(parents[q]) << " -> " << nodeName(u) << " [ name = " << edge_num++ << " ];\n";
+	}
+	fout << "}\n";
+	fout.close();
+
+	if (binary) {
+		ofstream bout(dfg_file + ".dfgb", ios::out | ios::binary);
+		if (!bout.is_open()) {
+			cerr << "Error: cannot write " << dfg_file << ".dfgb" << endl;
+			return 1;
+		}
+
+		// "DFGB", version, # of nodes, # of edges, one type byte per node, then (parent, child) pairs in the text order
+		bout.write("DFGB", 4);
+		put_u32(bout, 1);
+		put_u32(bout, N);
+		put_u32(bout, parents.size());
+		for (int u = 0; u < N; u++)
+			bout.put(static_cast<char>(type[u]));
+		for (int u = 0; u < N; u++)
+			for (int q = parentStart[u]; q < parentStart[u + 1]; q++) {
+				put_u32(bout, parents[q]);
+				put_u32(bout, u);
+			}
+		bout.close();
+	}
+
+	// Constraints line: <name> <target latency> <# of FUs of each type>.
+	// No FALLS target for a synthetic DFG (-1); each type gets the average # of its nodes per layer.
+	stringstream constraints;
+	constraints << name << " -1";
+	for (int t = 0; t < numberOfFunctionType; t++)
+		constraints << " " << std::max(1, (count[t] + depth / 2) / depth);
+
+	cout << "Generated " << dfg_file << ".txt: " << N << " nodes, " << parents.size() << " edges, " << depth << " layers (seed " << seed << ")" << endl;
+	cout << constraints.str() << endl;
+
+	if (!constraints_file.empty()) {
+		// the constraints files do not always end with a newline
+		bool newline = false;
+		ifstream last(constraints_file, ios::in | ios::binary);
+		if (last.is_open() && last.seekg(-1, ios::end) && last.get() != '\n')
+			newline = true;
+		last.close();
+
+		ofstream constraints_out(constraints_file, ios::app);
+		if (!constraints_out.is_open()) {
+			cerr << "Error: cannot append to " << constraints_file << endl;
+			return 1;
+		}
+		if (newline)
+			constraints_out << endl;
+		constraints_out << constraints.str() << endl;
+	}
+
+	return 0;
+}
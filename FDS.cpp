@@ -5,7 +5,11 @@
 // MODIFIED BY SILVIA, PLEASE
 
 #include "LS.h"
+#include "Perf.h"
+#include "ThreadPool.h"
 
+#include <algorithm>
+#include <cmath>
 #include <queue>
 #include <iostream>
 #include <string>
@@ -13,105 +17,699 @@
 
 using namespace std;
 
-extern int DFG;
-extern int LC;
-extern int opn;
-extern double latencyParameter;
-
-void output_schedule(string str, std::map<int, G_Node>& ops);
-void FDS(std::map<int, G_Node>& ops, std::vector<int>& delay, int& , double& latency_parameter, int tnum, bool debug);
-void getLCFDS(int& LC, double& latency_parameter, std::map<int, G_Node>& ops, std::vector<int>& delay);
-int checkParentFDS(G_Node* op, std::vector<int>& delay);
-void ALAPFDS(std::map<int, G_Node>& ops, std::vector<int>& delay, int& LC);
-void ASAPFDS(std::map<int, G_Node>& ops, std::vector<int>& delay);
-int checkChildFDS(G_Node* op, std::vector<int>& delay, int& LC);
-void update_depth(std::map<int, int>& op_depth, vector<int>& topo_order, std::map<int, G_Node>& ops);
-void get_pr_su_update_list(std::map<int, G_Node>& ops, std::map<int, std::vector<int>>& ops_update_pr_list,
+void output_schedule(string str, std::vector<NodeState>& state, int LC);
+void FDS(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC, double& latency_parameter, int tnum, bool debug, int threads, int lookahead);
+void getLCFDS(int& LC, double& latency_parameter, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay);
+int checkParentFDS(int op, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay);
+void ALAPFDS(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC);
+void ASAPFDS(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay);
+int checkChildFDS(int op, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC);
+void update_depth(std::map<int, int>& op_depth, vector<int>& topo_order, const DFGGraph& graph);
+void get_pr_su_update_list(const DFGGraph& graph, std::map<int, std::vector<int>>& ops_update_pr_list,
 	std::map<int, std::vector<int>>& ops_update_su_list,
 	std::map<int, int>& op_depth,
 	int& depth_limit);
 
 
+// Distribution graph DG[type][cc] of FDS(), kept up to date while the time frames of the operations narrow.
+// An op of delay D with frame [asap, alap] adds p = 1/(alap - asap + 1) to DG[t + d] for every start t of the frame
+// and 0 <= d < D: a trapezoid in cc, i.e. 4 point updates of the second difference of DG. Changing the frame of an
+// op costs O(1) (remove the old trapezoid, add the new one); materialize() rebuilds DG from it in O(tnum x LC).
+// materialize() also builds two levels of prefix sums of DG, so that the sums the forces need are O(1).
+struct DistributionGraph
+{
+	vector<vector<double>> DG;		//DG[type][cc], cc = 1..LC, valid after materialize()
+	vector<vector<double>> diff2;	//second difference of DG
+	vector<vector<double>> sum1;	//sum1[type][j] = DG[type][0] + .. + DG[type][j - 1]
+	vector<vector<double>> sum2;	//sum2[type][j] = sum1[type][0] + .. + sum1[type][j - 1]
+
+	void init(int tnum, int LC, int max_delay)
+	{
+		DG.assign(tnum, vector<double>(LC + 1, 0));
+		diff2.assign(tnum, vector<double>(LC + max_delay + 2, 0));
+		sum1.assign(tnum, vector<double>(LC + 2, 0));
+		sum2.assign(tnum, vector<double>(LC + 3, 0));
+	}
+
+	//sign = +1 adds the frame of an op, -1 removes it
+	void update(int type, int asap, int alap, int d, double sign)
+	{
+		double p = sign / double(alap - asap + 1);
+		vector<double>& dd = diff2[type];
+		dd[asap] += p;
+		dd[alap + 1] -= p;
+		dd[asap + d] -= p;
+		dd[alap + 1 + d] += p;
+	}
+
+	void materialize()
+	{
+		for (size_t type = 0; type < DG.size(); type++) {
+			double slope = 0.0, value = 0.0;
+			for (size_t cc = 0; cc < DG[type].size(); cc++) {
+				slope += diff2[type][cc];
+				value += slope;
+				DG[type][cc] = value;
+			}
+
+			for (size_t j = 1; j < sum1[type].size(); j++)
+				sum1[type][j] = sum1[type][j - 1] + DG[type][j - 1];
+			for (size_t j = 1; j < sum2[type].size(); j++)
+				sum2[type][j] = sum2[type][j - 1] + sum1[type][j - 1];
+		}
+	}
+
+	//DG[type][cc] + .. + DG[type][cc + d - 1]: the DG seen by an op of delay d started at cc
+	double window(int type, int cc, int d) const
+	{
+		return sum1[type][cc + d] - sum1[type][cc];
+	}
+
+	//window(type, cc, d) summed over the starts cc = first..last (0 if first > last)
+	double windows(int type, int first, int last, int d) const
+	{
+		if (first > last)
+			return 0.0;
+		const vector<double>& s2 = sum2[type];
+		return (s2[last + d + 1] - s2[first + d]) - (s2[last + 1] - s2[first]);
+	}
+};
+
+
+// Lookahead of the forces: besides the direct predecessors and successors, the frames of the ops up to depth
+// levels away (FDS lookahead, lists of get_pr_su_update_list) shrink when an op is fixed, and add their force.
+// depth = 1 is the direct ones only, depth = 0 the self force only.
+struct FDSLookahead
+{
+	int depth = 1;
+	vector<vector<int>> pr;		//indirect predecessors of each op, closest first (decreasing op depth)
+	vector<vector<int>> su;		//indirect successors of each op, closest first (increasing op depth)
+};
+
+
+// Force of the frame [asap, alap] of an op (type, delay D) shrinking to the events first..last, newP being the new
+// # of events: -dP * (DG + dP / 3) over the kept events and (DG - 1 / (3 oldP)) / oldP over the dropped ones
+static double frame_force(const DistributionGraph& dist, int type, int D, int asap, int alap, int first, int last, double newP)
+{
+	double oldP = double(alap - asap + 1);
+	double dP = 1.0 / newP - 1.0 / oldP;
+	double force = 0.0;
+
+	int kept = last - first + 1;
+	if (kept > 0)
+		force += -dP * (dist.windows(type, first, last, D) + kept * D * dP / 3.0);
+
+	int dropped = kept > 0 ? (alap - asap + 1) - kept : alap - asap + 1;
+	if (dropped > 0) {
+		double sum = kept > 0 ? dist.windows(type, asap, first - 1, D) + dist.windows(type, last + 1, alap, D)
+			: dist.windows(type, asap, alap, D);
+		force += (sum - dropped * D / 3.0 / oldP) / oldP;
+	}
+
+	return force;
+}
+
+
+// Forces on the indirect predecessors and successors of n when n is fixed at t: their new ALAP / ASAP are propagated
+// through the lookahead lists, closest ops first, and every frame that shrinks adds the force of the change.
+static double lookahead_force(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay,
+	const DistributionGraph& dist, const FDSLookahead& la, int n, int t)
+{
+	//bound[id]: tentative ALAP (then ASAP) of id, valid when seen[id] == stamp; per thread, the candidates run in parallel
+	static thread_local vector<int> bound, seen;
+	static thread_local int stamp = 0;
+	if (static_cast<int>(bound.size()) < graph.opn) {
+		bound.assign(graph.opn, 0);
+		seen.assign(graph.opn, 0);
+	}
+
+	double force = 0.0;
+	int n_D = delay[graph.type[n]];
+
+	//predecessors: new ALAP
+	stamp++;
+	bound[n] = t;
+	seen[n] = stamp;
+	for (int pr : graph.parents(n)) {
+		bound[pr] = std::min(state[pr].alap, t - delay[graph.type[pr]]);
+		seen[pr] = stamp;
+	}
+	for (int x : la.pr[n]) {
+		int D = delay[graph.type[x]];
+		int new_alap = state[x].alap;
+		for (int c : graph.children(x))
+			new_alap = std::min(new_alap, (seen[c] == stamp ? bound[c] : state[c].alap) - D);
+		bound[x] = state[x].schl ? state[x].alap : new_alap;
+		seen[x] = stamp;
+		if (!state[x].schl && new_alap < state[x].alap)
+			force += frame_force(dist, graph.type[x], D, state[x].asap, state[x].alap, state[x].asap, new_alap, double(new_alap - state[x].asap + 1));
+	}
+
+	//successors: new ASAP
+	stamp++;
+	bound[n] = t;
+	seen[n] = stamp;
+	for (int su : graph.children(n)) {
+		bound[su] = std::max(state[su].asap, t + n_D);
+		seen[su] = stamp;
+	}
+	for (int x : la.su[n]) {
+		int new_asap = state[x].asap;
+		for (int p : graph.parents(x))
+			new_asap = std::max(new_asap, (seen[p] == stamp ? bound[p] : state[p].asap) + delay[graph.type[p]]);
+		bound[x] = state[x].schl ? state[x].asap : new_asap;
+		seen[x] = stamp;
+		if (!state[x].schl && new_asap > state[x].asap)
+			force += frame_force(dist, graph.type[x], delay[graph.type[x]], state[x].asap, state[x].alap, new_asap, state[x].alap, double(state[x].alap - new_asap + 1));
+	}
+
+	return force;
+}
+
+
+// Force of scheduling op n at cc t: self force plus the forces on its unscheduled predecessors and successors,
+// whose frames shrink. Every term is a sum of DG over windows, taken from the prefix sums of dist.
+static double fds_force(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay,
+	const DistributionGraph& dist, const FDSLookahead& la, int n, int t)
+{
+	int type = graph.type[n];
+	int D = delay[type];
+	int asap = state[n].asap, alap = state[n].alap;
+	int frame = alap - asap + 1;		//# of old events of n
+	double p = 1.0 / double(frame);		//old event probability
+
+	//self force: p * (DG over the frame) - (DG at t), and the 1/3 terms of the D cc's of every event
+	double force = p * dist.windows(type, asap, alap, D) - dist.window(type, t, D)
+		- D / 3.0 * ((frame - 1) * p * p + (1.0 - p) * (1.0 - p));
+
+	if (la.depth < 1)
+		return force;
+
+	//Predecessors: only affect the P(n) alap, the events cc <= t - delay of the predecessor are the ones kept
+	for (int pr : graph.parents(n))
+	{
+		if (state[pr].schl)
+			continue;
+		double oldP = double(state[pr].alap - state[pr].asap + 1);
+		double newP = double(oldP - (frame - (t - asap + 1)));
+		force += frame_force(dist, graph.type[pr], delay[graph.type[pr]], state[pr].asap, state[pr].alap,
+			state[pr].asap, std::min(state[pr].alap, t - delay[graph.type[pr]]), newP);
+	}
+
+	//Successors: only affect the S(n) asap, the events cc >= t - delay of the successor are the ones kept
+	for (int su : graph.children(n))
+	{
+		if (state[su].schl)
+			continue;
+		double oldP = double(state[su].alap - state[su].asap + 1);
+		double newP = double(oldP - (frame - (alap - t + 1)));
+		force += frame_force(dist, graph.type[su], delay[graph.type[su]], state[su].asap, state[su].alap,
+			std::max(state[su].asap, t - delay[graph.type[su]]), state[su].alap, newP);
+	}
+
+	if (la.depth > 1)
+		force += lookahead_force(graph, state, delay, dist, la, n, t);
+
+	return force;
+}
+
+
+#ifdef FDS_CHECK_FORCE
+// Reference for fds_force(): the force summed cc by cc and delay step by delay step over DG.
+// Built with -DFDS_CHECK_FORCE, FDS() computes both for every candidate and reports the differences.
+std::atomic<long long> fds_force_checks(0), fds_force_mismatches(0);
+
+static double fds_force_loops(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay,
+	const vector<vector<double>>& DG, int n, int t)
+{
+	double force = 0.0; //initialize temp force value	
+	double temp = 1.0 / double(state[n].alap - state[n].asap + 1); // old event probability = 1/temp1
+	int temp1 = state[n].alap - state[n].asap + 1; // # of old events
+	double newP = 0.0, oldP = 0.0;
+
+	//self force: self = sum across MR { -(deltaP) * (DG + 1/3 * deltaP) };				
+	for (auto cc = state[n].asap; cc <= state[n].alap; cc++)
+		if (cc == t) // @temp scheduling cc t
+			for (auto d = 0; d < delay[graph.type[n]]; d++) //across multi-delay
+				force += -(1.0 - temp) * (DG[graph.type[n]][cc + d] + 1.0 / 3.0 * (1.0 - temp));
+		else
+			for (auto d = 0; d < delay[graph.type[n]]; d++) //across multi-delay
+				force += temp * (DG[graph.type[n]][cc + d] - 1.0 / 3.0 * temp);
+	//p-s force:
+	//Predecessors: only affect the P(n) alap: 
+	for (int pr : graph.parents(n))
+	{
+		if (state[pr].schl)
+			continue;
+		oldP = double(state[pr].alap - state[pr].asap + 1); //temp is the oldP
+		newP = double(oldP - (temp1 - (t - state[n].asap + 1))); //newP = oldP - [(n's oldP) - (t - n's ASAP + 1)]
+		temp = 1.0 / newP - 1.0 / oldP;
+		for (auto cc = state[pr].asap; cc <= state[pr].alap; cc++)
+			if (cc <= t - delay[graph.type[pr]])
+				for (auto d = 0; d < delay[graph.type[pr]]; d++)
+					force += -(DG[graph.type[pr]][cc + d] + temp / 3.0) * temp;
+			else
+				for (auto d = 0; d < delay[graph.type[pr]]; d++)
+					force += (DG[graph.type[pr]][cc + d] - 1.0 / 3.0 / oldP) / oldP;
+	}
+	//Successors: only affect the S(n) asap:
+	for (int su : graph.children(n))
+	{
+		if (state[su].schl)
+			continue;
+		oldP = double(state[su].alap - state[su].asap + 1); //temp is the oldP
+		newP = double(oldP - (temp1 - (state[n].alap - t + 1))); //newP = oldP - [(n's oldP) - (n's ALAP -t + 1)]
+		temp = 1.0 / newP - 1.0 / oldP;
+		for (auto cc = state[su].asap; cc <= state[su].alap; cc++)
+			if (cc >= t - delay[graph.type[su]])
+				for (auto d = 0; d < delay[graph.type[su]]; d++)
+					force += -(DG[graph.type[su]][cc + d] + temp / 3.0) * temp;
+			else
+				for (auto d = 0; d < delay[graph.type[su]]; d++)
+					force += (DG[graph.type[su]][cc + d] - 1.0 / 3.0 / oldP) / oldP;
+	}
+	return force;
+}
+#endif
+
+
+// Inner loops with fewer (n, t) candidates than this are not split between threads
+#define FDS_PARALLEL_MIN_CANDIDATES 4096
+
+// FDS runs of FDS_Outer_Loop() before giving up on a feasible LC
+#define FDS_MAX_RUNS 200
+
+struct FDSCandidate
+{
+	double force = 0.0;
+	int node = -1, t = -1;		//t < 0: no candidate
+};
+
+// Best candidate (n, t) of the unscheduled ops first..last-1. The forces are the textbook ones negated, so the best is
+// the highest; ties go to the smallest op ID, then the smallest cc (first found).
+static FDSCandidate best_candidate(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay,
+	const DistributionGraph& dist, const FDSLookahead& la, int first, int last)
+{
+	FDSCandidate best;
+
+	for (auto n = first; n < last; n++) //check all unscheduled node
+	{
+		if (state[n].schl)
+			continue;
+		for (auto t = state[n].asap; t <= state[n].alap; t++) //check all cc (all event) in MR of n [asap, alap]
+		{
+			//Note HERE: You may need to use the intermediate ASAP/ALAP update for accurate tentative MR update for all unscheduled predecessors and successors.
+			// 
+			//The force is computed based on the "self" operation u's tentative scheduling (cc t) change, for predecessors and successors too.
+			double force = fds_force(graph, state, delay, dist, la, n, t);
+
+#ifdef FDS_CHECK_FORCE
+			//the reference loops cover the direct predecessors and successors only, deeper lookaheads are not checked
+			if (la.depth == 1) {
+				double loop_force = fds_force_loops(graph, state, delay, dist.DG, n, t);
+				fds_force_checks++;
+				if (loop_force != force && !(std::fabs(loop_force - force) <= 1e-9 * std::max(1.0, std::fabs(loop_force)))) {
+					fds_force_mismatches++;
+					cerr << "FDS force mismatch: op " << n << " cc " << t << ": " << force << " (loops: " << loop_force << ")" << endl;
+				}
+			}
+#endif
+
+			if (best.t < 0 || force > best.force) //update best node, cc, force value
+			{
+				best.force = force;
+				best.node = n;
+				best.t = t;
+			}
+		} // end MR
+	}// end one operation inner loop
+
+	return best;
+}
+
+
+
+
+// After op x is fixed at a cc, updates the ASAP of its unscheduled descendants and the ALAP of its unscheduled ancestors.
+// Same values as the full topological passes, but only the ops whose frame actually changes are visited: the successors
+// of a changed op are queued, and taken in increasing depth (decreasing for the ALAP), so each one is recomputed after
+// all its changed predecessors.
+static void update_frames(const DFGGraph& graph, std::vector<NodeState>& state, const std::vector<int>& delay,
+	const vector<int>& op_depth, int LC, int x, vector<char>& queued)
+{
+	typedef std::pair<int, int> DepthOp;
+
+	//intermediate ASAP update.
+	std::priority_queue<DepthOp, vector<DepthOp>, std::greater<DepthOp>> asap_q;
+	for (int su : graph.children(x))
+		if (!state[su].schl && !queued[su]) {
+			queued[su] = 1;
+			asap_q.push(std::make_pair(op_depth[su], su));
+		}
+
+	while (!asap_q.empty()) {
+		int w = asap_q.top().second;
+		asap_q.pop();
+		queued[w] = 0;
+
+		int max_asap = 1;
+		for (int pr : graph.parents(w))
+			max_asap = std::max(max_asap, state[pr].asap + delay[graph.type[pr]]);
+		if (max_asap == state[w].asap)
+			continue;
+
+		state[w].asap = max_asap;
+		for (int su : graph.children(w))
+			if (!state[su].schl && !queued[su]) {
+				queued[su] = 1;
+				asap_q.push(std::make_pair(op_depth[su], su));
+			}
+	}
+
+	//intermediate ALAP update.
+	std::priority_queue<DepthOp> alap_q;
+	for (int pr : graph.parents(x))
+		if (!state[pr].schl && !queued[pr]) {
+			queued[pr] = 1;
+			alap_q.push(std::make_pair(op_depth[pr], pr));
+		}
+
+	while (!alap_q.empty()) {
+		int w = alap_q.top().second;
+		alap_q.pop();
+		queued[w] = 0;
+
+		int D = delay[graph.type[w]];
+		int min_alap = LC - D + 1;
+		for (int su : graph.children(w))
+			min_alap = std::min(min_alap, state[su].alap - D);
+		if (min_alap == state[w].alap)
+			continue;
+
+		state[w].alap = min_alap;
+		for (int pr : graph.parents(w))
+			if (!state[pr].schl && !queued[pr]) {
+				queued[pr] = 1;
+				alap_q.push(std::make_pair(op_depth[pr], pr));
+			}
+	}
+}
 
-void FDS_Outer_Loop(std::map<int, G_Node>& ops, std::vector<int>& delay, int& LC,
-        double& latencyParameter, std::vector<int>& res_constr, bool debug) {
 
+// Checks the resource constraints on a FDS schedule (state[i].asap = start cc of op i). As in the checker, an op
+// keeps its FU busy for all the cc's of its delay. Returns the # of FUs over the constraints, summed over the types
+// (0: feasible).
+static int fds_excess(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay,
+	const std::vector<int>& res_constr)
+{
 	int tnum = delay.size();
 
-    bool feasible = false;
-    int iteration = 0;
-
-	// Loop until a feasible solution is found or max iterations reached
-    while (!feasible && iteration < 200) { 
-        iteration++;
-
-        // Run standard FDS scheduling
-        FDS(ops, delay, LC, latencyParameter, tnum, debug);
-
-        // 2. Calcola l'uso effettivo di risorse per ogni ciclo di clock
-        std::vector<int> max_used(tnum, 0); // Massima risorsa usata per tipo.
-        
-        // La schedule termina al tempo massimo di fine operazione.
-        int actual_max_latency = 0;
-        for (auto& [_, node] : ops) {
-            int finish_time = node.asap + delay[node.type] - 1;
-            if (finish_time > actual_max_latency) {
-                actual_max_latency = finish_time;
-            }
-        }
-
-        // Vettore per tracciare l'uso di risorse per ciclo di clock: usage[Type][CC]
-        std::vector<std::vector<int>> usage(tnum, std::vector<int>(actual_max_latency + 1, 0)); 
-        
-        for (auto& [_, node] : ops) {
-            if (node.asap > 0) { // Se l'operazione è stata schedulata (FDS fallisce se non schedula)
-                // L'operazione inizia in node.asap e usa 1 risorsa di tipo node.type
-                usage[node.type][node.asap]++;
-            }
-        }
-
-        // 3. Verifica la fattibilità: controlla se l'uso massimo supera il vincolo di risorsa
-        feasible = true;
-        for (size_t type = 0; type < tnum; ++type) {
-            // Controlla l'uso in tutti i cicli di clock
-            for (int cc = 1; cc <= actual_max_latency; ++cc) {
-                if (usage[type][cc] > res_constr[type]) {
-                    feasible = false;
-                    break;
-                }
-            }
-            if (!feasible) break; // Non appena un vincolo è violato, interrompi
-        }
-        
-        // 4. Se non fattibile, aumenta LC e riprova
-        if (!feasible) {
-            // Aumenta LC di un valore ragionevole.
-            // Il tuo codice usa LC += 3, che è un incremento aggressivo ma valido.
-            LC += 3;
+	// La schedule termina al tempo massimo di fine operazione.
+	int actual_max_latency = 0;
+	for (int i = 0; i < graph.opn; i++) {
+		int finish_time = state[i].asap + delay[graph.type[i]] - 1;
+		if (finish_time > actual_max_latency)
+			actual_max_latency = finish_time;
+	}
 
-			if (debug)
-            	std::cout << "[ML_RCS] Violated constraints, increasing LC to "
-                      << LC << " (iteration " << iteration << ")\n";
-        }
-    }
+	// Vettore per tracciare l'uso di risorse per ciclo di clock: usage[Type][CC]
+	std::vector<std::vector<int>> usage(tnum, std::vector<int>(actual_max_latency + 1, 0));
+
+	for (int i = 0; i < graph.opn; i++)
+		if (state[i].asap > 0) // Se l'operazione è stata schedulata (FDS fallisce se non schedula)
+			for (int cc = state[i].asap; cc < state[i].asap + delay[graph.type[i]]; cc++)
+				usage[graph.type[i]][cc]++;
+
+	// Verifica la fattibilità: controlla se l'uso massimo supera il vincolo di risorsa
+	int excess = 0;
+	for (int type = 0; type < tnum; ++type) {
+		int peak = 0;
+		for (int cc = 1; cc <= actual_max_latency; ++cc)
+			peak = std::max(peak, usage[type][cc]);
+		excess += std::max(0, peak - res_constr[type]);
+	}
+
+	return excess;
+}
+
+
+// Schedule returned by FDS_Outer_Loop() when no LC meets the constraints: the one with the fewest FUs over them
+// (the smallest LC among equals)
+struct FDSFallback
+{
+	int excess = -1;
+	int LC = 0;
+	vector<NodeState> state;
+};
+
+
+// Runs FDS() at each LC of lcs, probes[k] is the schedule at lcs[k]. With several LCs they run in parallel
+// (one thread each), a single LC gets all the threads for its candidates. The infeasible schedules update fallback.
+static void fds_probe(const DFGGraph& graph, std::vector<int>& delay, double latencyParameter, std::vector<int>& res_constr,
+	const vector<int>& lcs, vector<vector<NodeState>>& probes, vector<char>& feasible, FDSFallback& fallback,
+	bool debug, int threads, int lookahead)
+{
+	int count = lcs.size();
+	probes.assign(count, vector<NodeState>());
+	feasible.assign(count, 0);
+	vector<int> excess(count, 0);
+
+	const std::atomic<bool>* cancel = schedule_cancel;	//the workers follow the cancellation of the caller
+	parallel_for(count, count == 1 ? 1 : threads, [&](int k) {
+		schedule_cancel = cancel;
+		int lc = lcs[k];
+		double lp = latencyParameter;
+		FDS(graph, probes[k], delay, lc, lp, delay.size(), debug && count == 1, count == 1 ? threads : 1, lookahead);
+		excess[k] = fds_excess(graph, probes[k], delay, res_constr);
+		feasible[k] = excess[k] == 0;
+	});
+
+	for (int k = 0; k < count; k++) {
+		if (excess[k] > 0 && (fallback.excess < 0 || excess[k] < fallback.excess || (excess[k] == fallback.excess && lcs[k] < fallback.LC))) {
+			fallback.excess = excess[k];
+			fallback.LC = lcs[k];
+			fallback.state = probes[k];
+		}
 
-    if (!feasible)
 		if (debug)
-        	std::cout << "[ML_RCS] WARNING: did not reach a feasible solution after "
-                  << iteration << " iterations.\n";
+			std::cout << "[ML_RCS] LC " << lcs[k] << (feasible[k] ? ": feasible\n" : ": violated constraints\n");
+	}
+}
+
+
+// The schedule is returned in state: state[i].asap is the start cc of operation i, LC is its latency constraint.
+// LC > 0 on entry is the first LC tried, otherwise the ASAP latency x latencyParameter.
+// bisect = false: the LC grows by 3 after each infeasible FDS run, up to FDS_MAX_RUNS runs.
+// bisect = true: the LC is bracketed between an infeasible and a feasible value (the steps above an infeasible start
+// double, below a feasible start the ASAP latency bounds it) and the bracket is bisected down to the tightest LC.
+// probes > 1 splits the bracket into probes + 1 parts per round and runs the probes in parallel on threads workers:
+// fewer rounds, more FDS runs. The result depends on probes, not on threads.
+// Returns whether a feasible schedule was found; fds_runs is the # of FDS runs used. Without a feasible LC, the schedule
+// returned is the one exceeding the constraints by the fewest FUs.
+bool FDS_Outer_Loop(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC,
+        double& latencyParameter, std::vector<int>& res_constr, bool debug, int threads, int lookahead,
+		bool bisect, int probes, int& fds_runs) {
+
+	if (threads <= 0)
+		threads = default_thread_count();
+	probes = std::max(1, probes);
+
+	//ASAP latency: lower bound of every LC, and the first LC when none is given
+	int asap_latency = 0, start_lc = 0;
+	{
+		vector<NodeState> asap_state(graph.opn);
+		double one = 1.0;
+		ASAPFDS(graph, asap_state, delay);
+		getLCFDS(asap_latency, one, graph, asap_state, delay);
+		getLCFDS(start_lc, latencyParameter, graph, asap_state, delay);
+	}
+	LC = std::max(LC > 0 ? LC : start_lc, asap_latency);
+
+	fds_runs = 0;
+	vector<vector<NodeState>> runs;
+	vector<char> feasible;
+	FDSFallback fallback;
+
+	//+3 steps from the LC, up to FDS_MAX_RUNS runs; the LCs in tried are known to be infeasible and are not run again
+	auto step_search = [&](const vector<int>& tried) {
+		bool found = false;
+		int step_runs = 0;
+
+		// Loop until a feasible solution is found or max iterations reached
+		while (!found && step_runs < FDS_MAX_RUNS && !schedule_cancelled()) {
+			step_runs++;
+			if (std::find(tried.begin(), tried.end(), LC) == tried.end()) {
+				fds_probe(graph, delay, latencyParameter, res_constr, vector<int>(1, LC), runs, feasible, fallback, debug, threads, lookahead);
+				fds_runs++;
+				state = runs[0];
+				found = feasible[0];
+			}
+
+			// Se non fattibile, aumenta LC e riprova
+			if (!found) {
+				LC += 3;
+
+				if (debug)
+					std::cout << "[ML_RCS] Violated constraints, increasing LC to "
+						<< LC << " (iteration " << step_runs << ")\n";
+			}
+		}
+
+		if (!found) {
+			LC = fallback.LC;
+			state = fallback.state;
+			if (debug)
+				std::cout << "[ML_RCS] WARNING: did not reach a feasible solution after "
+					<< fds_runs << " iterations.\n";
+		}
+		return found;
+	};
+
+	if (!bisect)
+		return step_search(vector<int>());
+
+	//bracket: lo is infeasible (or below the ASAP latency), hi feasible. The steps go as far as the +3 steps would.
+	//The search assumes that feasibility is monotone in the LC, which FDS only approximates: a feasible LC may lie
+	//below the one found, and the doubling steps may jump over a window of feasible LCs. When they find no feasible
+	//LC, the +3 steps are run from the start LC, so bisection finds one whenever the +3 steps do.
+	int start = LC;
+	vector<int> tried;
+	int lo = asap_latency - 1, hi = -1;
+	int max_lc = LC + 3 * FDS_MAX_RUNS;
+
+	fds_probe(graph, delay, latencyParameter, res_constr, vector<int>(1, LC), runs, feasible, fallback, debug, threads, lookahead);
+	fds_runs++;
+	state = runs[0];
+	if (feasible[0])
+		hi = LC;
+	else {
+		lo = LC;
+		tried.push_back(LC);
+		int step = 3;
+		while (hi < 0 && lo < max_lc && fds_runs < FDS_MAX_RUNS && !schedule_cancelled()) {
+			vector<int> lcs;
+			for (int k = 1; k <= probes && (lcs.empty() || lcs.back() < max_lc); k++)
+				lcs.push_back(static_cast<int>(std::min<long long>(lo + (long long)k * step, max_lc)));
+
+			fds_probe(graph, delay, latencyParameter, res_constr, lcs, runs, feasible, fallback, debug, threads, lookahead);
+			fds_runs += lcs.size();
+
+			for (size_t k = 0; k < lcs.size() && hi < 0; k++) {
+				if (feasible[k]) {
+					hi = lcs[k];
+					state = runs[k];
+				} else {
+					lo = lcs[k];
+					tried.push_back(lcs[k]);
+				}
+			}
+			step *= 2;
+		}
+
+		if (hi < 0) {
+			if (schedule_cancelled())
+				return false;
+			if (debug)
+				std::cout << "[ML_RCS] no feasible LC with doubling steps after " << fds_runs << " FDS runs, +3 steps from LC " << start << "\n";
+
+			LC = start;
+			if (!step_search(tried))
+				return false;
+
+			//bisect between the last infeasible step and the feasible LC found
+			hi = LC;
+			lo = hi - 3;
+		}
+	}
+
+	//bisection: the smallest feasible probe becomes hi, the largest infeasible one below it lo
+	while (hi - lo > 1 && !schedule_cancelled()) {
+		vector<int> lcs;
+		for (int k = 1; k <= probes; k++) {
+			int lc = lo + (long long)(hi - lo) * k / (probes + 1);
+			if (lc > lo && lc < hi && (lcs.empty() || lc > lcs.back()))
+				lcs.push_back(lc);
+		}
+
+		fds_probe(graph, delay, latencyParameter, res_constr, lcs, runs, feasible, fallback, debug, threads, lookahead);
+		fds_runs += lcs.size();
+
+		int new_hi = hi, best = -1;
+		for (size_t k = 0; k < lcs.size(); k++)
+			if (feasible[k]) {
+				new_hi = lcs[k];
+				best = k;
+				break;
+			}
+		for (size_t k = 0; k < lcs.size(); k++)
+			if (!feasible[k] && lcs[k] < new_hi)
+				lo = std::max(lo, lcs[k]);
+
+		if (best >= 0)
+			state = runs[best];
+		hi = new_hi;
+	}
+
+	LC = hi;
+	if (debug)
+		std::cout << "[ML_RCS] tightest feasible LC " << LC << " after " << fds_runs << " FDS runs\n";
+	return true;
 }
 
 
 
-void output_schedule(string str, std::map<int, G_Node>& ops)
+// Binds a FDS schedule to FUs, in the form LS() returns it: the ops of each type are taken by start cc and each one
+// goes to the first FU free at that cc (left edge), so a type uses as many FUs as its peak # of ops in flight.
+void FDS_Binding(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay,
+	std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult,
+	int& actualLatency)
+{
+	int tnum = delay.size();
+
+	schlResult.clear();
+	FUAllocationResult.clear();
+	bindingResult.clear();
+	actualLatency = 0;
+
+	vector<vector<int>> ops_of_type(tnum);
+	for (int i = 0; i < graph.opn; i++) {
+		schlResult[i] = state[i].asap;
+		ops_of_type[graph.type[i]].push_back(i);
+		actualLatency = std::max(actualLatency, state[i].asap + delay[graph.type[i]] - 1);
+	}
+
+	for (int type = 0; type < tnum; type++) {
+		vector<int>& ops = ops_of_type[type];
+		std::stable_sort(ops.begin(), ops.end(), [&](int a, int b) { return state[a].asap < state[b].asap; });
+
+		vector<int> free_at;	//first cc at which each FU of the type is free
+		for (int op : ops) {
+			int fu = 0;
+			while (fu < static_cast<int>(free_at.size()) && free_at[fu] > state[op].asap)
+				fu++;
+			if (fu == static_cast<int>(free_at.size()))
+				free_at.push_back(0);
+
+			free_at[fu] = state[op].asap + delay[type];
+			bindingResult[type][fu].push_back(op);
+		}
+
+		FUAllocationResult[type] = free_at.size();
+	}
+}
+
+
+void output_schedule(string str, std::vector<NodeState>& state, int LC)
 {
+	int opn = state.size();
+
 	//obtain filename to output
 
 	ofstream fout_s(str, ios::out | ios::app);	//output file to save the scheduling results
 	fout_s << "LC " << LC << endl;
 	for (int i = 0; i < opn; i++) {
-		//std::cout << i << " " << ops[i].asap << endl;	//after scheduling, ASAP = ALAP of each node
-		fout_s << i << " " << ops[i].asap << endl;
+		//std::cout << i << " " << state[i].asap << endl;	//after scheduling, ASAP = ALAP of each node
+		fout_s << i << " " << state[i].asap << endl;
 	}
 	//fout_s << "*********************************************" << endl;
 	fout_s.close();
@@ -121,27 +719,49 @@ void output_schedule(string str, std::map<int, G_Node>& ops)
 //---------------------------------------//
 //----------------FDS--------------------//
 //---------------------------------------//
-void FDS(std::map<int, G_Node>& ops, std::vector<int>& delay, int& , double& latency_parameter, int tnum, bool debug) 
+//threads: workers evaluating the candidates of an iteration (<= 0: one per core); the schedule does not depend on it
+//lookahead: depth of the predecessors / successors whose forces are added (0: self force only, 1: direct ones)
+//LC: latency constraint when > 0 on entry (raised to the ASAP latency), otherwise set to ASAP latency x latency_parameter
+void FDS(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC, double& latency_parameter, int tnum, bool debug, int threads, int lookahead) 
 {
+	PERF_SCOPE(PERF_FDS);
+
+	int opn = graph.opn;
+	state.assign(opn, NodeState());	//values of this run, graph is only read
+
 	//find latency constraint
 	//Obtain ASAP latency first
-	ASAPFDS(ops,delay); //Obtain ASAP for each operation
-	getLCFDS(LC, latency_parameter,ops, delay);
-	ALAPFDS(ops, delay, LC); //Obtain ALAP for each operation
+	ASAPFDS(graph, state, delay); //Obtain ASAP for each operation
+	if (LC > 0) { //given LC, at least the ASAP latency
+		int asap_latency = 0;
+		double one = 1.0;
+		getLCFDS(asap_latency, one, graph, state, delay);
+		LC = std::max(LC, asap_latency);
+	}
+	else
+		getLCFDS(LC, latency_parameter, graph, state, delay);
+	ALAPFDS(graph, state, delay, LC); //Obtain ALAP for each operation
 
 	//start FDS
 	//initialize DG by tnum X (LC+1) note that, starts from cc = 0 to LC, but we don't do compuation in row cc = 0.
-	vector<vector<double>> DG(tnum, vector<double>(LC + 1, 0)); //DG[TYPE][CC]
+	DistributionGraph dist;
+	dist.init(tnum, LC, *std::max_element(delay.begin(), delay.end()));
+
+	//frame of each op currently counted in DG (asap = -1: not counted yet)
+	vector<int> dg_asap(opn, -1), dg_alap(opn, -1);
 	double bestForce = 0.0; //best scheduling force value
-	int bestNode = -1, bestT = -1, iteration = 0, temp1; // best Node ID and T (cc), # of iteration; 
-	double temp = 0.0, force = 0.0, newP = 0.0, oldP = 0.0;	//newP/oldP for the compuataion of force
+	int bestNode = -1, bestT = -1, iteration = 0; // best Node ID and T (cc), # of iteration; 
+
+	if (threads <= 0)
+		threads = default_thread_count();
+	vector<FDSCandidate> block_best;	//best candidate of each block of ops, when the inner loop runs in parallel
 
 	std::map<int, int> op_depth;
 
 	vector<int> topo_order;
 	topo_order.clear();
 
-	update_depth(op_depth, topo_order, ops);
+	update_depth(op_depth, topo_order, graph);
 
 	//int prev_schl_op = -1;
 
@@ -177,10 +797,31 @@ void FDS(std::map<int, G_Node>& ops, std::vector<int>& delay, int& , double& lat
 
 	//get depth of operations will be udated
 	//using max_d or other values //max_d = update all.
-	int depth_limit = 1;
-
-	get_pr_su_update_list(ops, ops_update_pr_list, ops_update_su_list,
-		op_depth, depth_limit);
+	int depth_limit = lookahead;
+
+	//lists of the lookahead forces: the direct pr's / su's are taken from the graph, the lists keep the others,
+	//ordered so that an op comes after the ones between it and the listed op
+	FDSLookahead la;
+	la.depth = lookahead;
+	if (lookahead > 1) {
+		get_pr_su_update_list(graph, ops_update_pr_list, ops_update_su_list,
+			op_depth, depth_limit);
+
+		la.pr.resize(opn);
+		la.su.resize(opn);
+		for (auto i = 0; i < opn; i++) {
+			DFGGraph::IdRange parents = graph.parents(i);
+			DFGGraph::IdRange children = graph.children(i);
+			for (int pr : ops_update_pr_list[i])
+				if (std::find(parents.begin(), parents.end(), pr) == parents.end())
+					la.pr[i].push_back(pr);
+			for (int su : ops_update_su_list[i])
+				if (std::find(children.begin(), children.end(), su) == children.end())
+					la.su[i].push_back(su);
+			std::stable_sort(la.pr[i].begin(), la.pr[i].end(), [&](int a, int b) { return op_depth[a] > op_depth[b]; });
+			std::stable_sort(la.su[i].begin(), la.su[i].end(), [&](int a, int b) { return op_depth[a] < op_depth[b]; });
+		}
+	}
 
 
 	//example of initial ASAP update
@@ -189,26 +830,26 @@ void FDS(std::map<int, G_Node>& ops, std::vector<int>& delay, int& , double& lat
 
 		int w = *it;
 
-		if (ops[w].schl)
+		if (state[w].schl)
 			continue;
 
-		if (ops[w].parent.empty())
-			ops[w].asap = 1;
+		if (graph.parents(w).empty())
+			state[w].asap = 1;
 		else {
 
 			int max_asap = 1;
 
-			for (auto pr = ops[w].parent.begin(); pr != ops[w].parent.end(); pr++) {
+			for (int pr : graph.parents(w)) {
 
-				int pr_type = (*pr)->type;
+				int pr_type = graph.type[pr];
 				int pr_delay = delay[pr_type];
-				int pr_asap = (*pr)->asap;
+				int pr_asap = state[pr].asap;
 
 				if (max_asap <= pr_asap + pr_delay)
 					max_asap = pr_asap + pr_delay;
 			}
 
-			ops[w].asap = max_asap;
+			state[w].asap = max_asap;
 		}
 	}
 
@@ -217,250 +858,147 @@ void FDS(std::map<int, G_Node>& ops, std::vector<int>& delay, int& , double& lat
 	for (auto it = reverse_topo.begin(); it != reverse_topo.end(); it++) {
 		int w = *it;
 
-		if (ops[w].schl)
+		if (state[w].schl)
 			continue;
 
-		if (ops[w].child.empty())
-			ops[w].alap = LC - delay[ops[w].type] + 1;
+		if (graph.children(w).empty())
+			state[w].alap = LC - delay[graph.type[w]] + 1;
 		else {
-			int min_alap = LC - delay[ops[w].type] + 1;
+			int min_alap = LC - delay[graph.type[w]] + 1;
 
-			for (auto su = ops[w].child.begin(); su != ops[w].child.end(); su++) {
+			for (int su : graph.children(w)) {
 
-				int su_type = (*su)->type;
-				int su_alap = (*su)->alap;
+				int su_type = graph.type[su];
+				int su_alap = state[su].alap;
 
-				if (min_alap >= su_alap - delay[ops[w].type])
-					min_alap = su_alap - delay[ops[w].type];
+				if (min_alap >= su_alap - delay[graph.type[w]])
+					min_alap = su_alap - delay[graph.type[w]];
 			}
 
-			ops[w].alap = min_alap;
+			state[w].alap = min_alap;
 		}
 	}
 
 
-	while (1) //outer loop
-	{
-		if (iteration != 0) //starting from second iteration, update node's ASAP/ALAP first.
-		{
-			for (auto i = 0; i < opn; i++)
-				if (ops[i].asap == ops[i].alap && !ops[i].schl) {
-					// ops[i].prev_alap = ops[i].alap;
-					// ops[i].prev_asap = ops[i].asap;
-				}
-
-			//intermediate ASAP update.
-			for (auto it = topo_order.begin(); it != topo_order.end(); it++) {
-
-				int w = *it;
-
-				if (ops[w].schl)
-					continue;
-
-				if (ops[w].parent.empty())
-					ops[w].asap = 1;
-				else {
-
-					int max_asap = 1;
-
-					for (auto pr = ops[w].parent.begin(); pr != ops[w].parent.end(); pr++) {
-
-						int pr_type = (*pr)->type;
-						int pr_delay = delay[pr_type];
-						int pr_asap = (*pr)->asap;
-
-						if (max_asap <= pr_asap + pr_delay)
-							max_asap = pr_asap + pr_delay;
-					}
-
-					ops[w].asap = max_asap;
-				}
-			}
-
-
-			//intermediate ALAP update.
-			for (auto it = reverse_topo.begin(); it != reverse_topo.end(); it++) {
-				int w = *it;
-
-				if (ops[w].schl)
-					continue;
-
-				if (ops[w].child.empty())
-					ops[w].alap = LC - delay[ops[w].type] + 1;
-				else {
-					int min_alap = LC - delay[ops[w].type] + 1;
-
-					for (auto su = ops[w].child.begin(); su != ops[w].child.end(); su++) {
-
-						int su_type = (*su)->type;
-						int su_alap = (*su)->alap;
-
-						if (min_alap >= su_alap - delay[ops[w].type])
-							min_alap = su_alap - delay[ops[w].type];
-					}
-
-					ops[w].alap = min_alap;
-				}
-			}
-		}
+	//op_depth as a vector for update_frames()
+	vector<int> op_depth_v(opn);
+	for (auto i = 0; i < opn; i++)
+		op_depth_v[i] = op_depth[i];
+	vector<char> queued(opn, 0);
 
-		//generate DG
+	while (!schedule_cancelled()) //outer loop, the schedule is left unfinished when cancelled
+	{
+		//update DG: only the ops whose frame changed since the last iteration are moved
 		for (auto i = 0; i < opn; i++) //for each node
 		{   //if node has asap = alap and not be scheduled, schedule it directly (only 1 available cc)
-			if (ops[i].asap == ops[i].alap && !ops[i].schl)
-				ops[i].schl = true;
-			temp = 1.0 / double(ops[i].alap - ops[i].asap + 1); //set temp = scheduling probability = 1/(# of event), to be fast computed.
-			for (auto t = ops[i].asap; t <= ops[i].alap; t++) //asap to alap cc range,
-				for (auto d = 0; d < delay[ops[i].type]; d++) //delay
-					DG[ops[i].type][t + d] += temp; //compute DG
-		}//end DG generation
+			if (state[i].asap == state[i].alap && !state[i].schl)
+				state[i].schl = true;
+			if (state[i].asap == dg_asap[i] && state[i].alap == dg_alap[i])
+				continue;
+			int d = delay[graph.type[i]];
+			if (dg_asap[i] > 0)
+				dist.update(graph.type[i], dg_asap[i], dg_alap[i], d, -1.0);
+			dist.update(graph.type[i], state[i].asap, state[i].alap, d, 1.0);
+			dg_asap[i] = state[i].asap;
+			dg_alap[i] = state[i].alap;
+		}
+		dist.materialize();
 
 
 		/*for (auto i = 0; i < tnum; i++)
 			for (auto j = 1; j <= LC; j++)
 			{
-				if (DG[i][j] != 0)
-					cout << "DG type = " << i << " , on cc " << j << " : " << DG[i][j] << endl;
+				if (dist.DG[i][j] != 0)
+					cout << "DG type = " << i << " , on cc " << j << " : " << dist.DG[i][j] << endl;
 			}*/
 
-			//start inner loop:
-			//initialize best node parameter;
-		bestForce = 0.0;
-		bestNode = bestT = -1;
+		//start inner loop:
+		//the candidates of blocks of consecutive ops are evaluated in parallel (DG and the frames are only read),
+		//then the best of each block is reduced in op order: same tie-breaking as one sequential scan
+		int candidates = 0;
+		for (auto n = 0; n < opn; n++)
+			if (!state[n].schl)
+				candidates += state[n].alap - state[n].asap + 1;
+
+		FDSCandidate best;
+		if (threads == 1 || candidates < FDS_PARALLEL_MIN_CANDIDATES)
+			best = best_candidate(graph, state, delay, dist, la, 0, opn);
+		else {
+			int block = std::max(16, opn / (8 * threads));
+			int blocks = (opn + block - 1) / block;
+			block_best.assign(blocks, FDSCandidate());
 
-		for (auto n = 0; n < opn; n++) //check all unscheduled node
-		{
-			if (ops[n].schl)
-				continue;
-			for (auto t = ops[n].asap; t <= ops[n].alap; t++) //check all cc (all event) in MR of n [asap, alap]
-			{
+			parallel_for(blocks, threads, [&](int b) {
+				block_best[b] = best_candidate(graph, state, delay, dist, la, b * block, std::min(opn, (b + 1) * block));
+			});
 
-				//Note HERE: You may need to use the intermediate ASAP/ALAP update for accurate tentative MR update for all unscheduled predecessors and successors.
-				// 
-				//Below is the force computation. Note that, for predecessors and successors below, this version (for highest efficiency) is computed based on the "self" operation u's tentative scheduling (cc t) change.
-
-				force = 0.0; //initialize temp force value	
-				temp = 1.0 / double(ops[n].alap - ops[n].asap + 1); // old event probability = 1/temp1
-				temp1 = ops[n].alap - ops[n].asap + 1; // # of old events
-
-				//self force: self = sum across MR { -(deltaP) * (DG + 1/3 * deltaP) };				
-				for (auto cc = ops[n].asap; cc <= ops[n].alap; cc++)
-					if (cc == t) // @temp scheduling cc t
-						for (auto d = 0; d < delay[ops[n].type]; d++) //across multi-delay
-							force += -(1.0 - temp) * (DG[ops[n].type][cc + d] + 1.0 / 3.0 * (1.0 - temp));
-					else
-						for (auto d = 0; d < delay[ops[n].type]; d++) //across multi-delay
-							force += temp * (DG[ops[n].type][cc + d] - 1.0 / 3.0 * temp);
-				//p-s force:
-				//Predecessors: only affect the P(n) alap: 
-				newP = 0.0;
-				oldP = 0.0;
-				for (auto it = ops[n].parent.begin(); it != ops[n].parent.end(); it++)
-				{
-					if ((*it)->schl)
-						continue;
-					oldP = double((*it)->alap - (*it)->asap + 1); //temp is the oldP
-					newP = double(oldP - (temp1 - (t - ops[n].asap + 1))); //newP = oldP - [(n's oldP) - (t - n's ASAP + 1)]
-					temp = 1.0 / newP - 1.0 / oldP;
-					for (auto cc = (*it)->asap; cc <= (*it)->alap; cc++)
-						if (cc <= t - delay[(*it)->type])
-							for (auto d = 0; d < delay[(*it)->type]; d++)
-								force += -(DG[(*it)->type][cc + d] + temp / 3.0) * temp;
-						else
-							for (auto d = 0; d < delay[(*it)->type]; d++)
-								force += (DG[(*it)->type][cc + d] - 1.0 / 3.0 / oldP) / oldP;
-				}
-				//Successors: only affect the S(n) asap:
-				newP = 0.0;
-				oldP = 0.0;
-				for (auto it = ops[n].child.begin(); it != ops[n].child.end(); it++)
-				{
-					if ((*it)->schl)
-						continue;
-					oldP = double((*it)->alap - (*it)->asap + 1); //temp is the oldP
-					newP = double(oldP - (temp1 - (ops[n].alap - t + 1))); //newP = oldP - [(n's oldP) - (n's ALAP -t + 1)]
-					temp = 1.0 / newP - 1.0 / oldP;
-					for (auto cc = (*it)->asap; cc <= (*it)->alap; cc++)
-						if (cc >= t - delay[(*it)->type])
-							for (auto d = 0; d < delay[(*it)->type]; d++)
-								force += -(DG[(*it)->type][cc + d] + temp / 3.0) * temp;
-						else
-							for (auto d = 0; d < delay[(*it)->type]; d++)
-								force += (DG[(*it)->type][cc + d] - 1.0 / 3.0 / oldP) / oldP;
-				}
+			for (const FDSCandidate& c : block_best)
+				if (c.t >= 0 && (best.t < 0 || c.force > best.force))
+					best = c;
+		}
 
-				//Note, this version does not have a good tie-breaking consideration when multiple (operation, scheduling) options have the same cost;
-				//The default one is based on the operation ID (smallest) and clock cycles (smallest)
+		bestForce = best.force;
+		bestNode = best.node;
+		bestT = best.t;
+
+		if (debug && bestT >= 0)
+			cout << "[FDS] iteration " << iteration << ": op " << bestNode << " at cc " << bestT << ", force " << bestForce << endl;
 
-				if (bestT < 0) //update best node, cc, force value
-				{
-					bestForce = force;
-					bestNode = n;
-					bestT = t;
-				}
-				else if (force > bestT)
-				{
-					bestForce = force;
-					bestNode = n;
-					bestT = t;
-				}
-			} // end MR
-		}// end one operation inner loop
 		//schedule the best node
 		if (bestT < 0) //when all nodes has been scheduled, bestT = -1 (not changed) and break the while to stop the process
 			break;
-		ops[bestNode].asap = ops[bestNode].alap = bestT;
-		ops[bestNode].schl = true;
+		state[bestNode].asap = state[bestNode].alap = bestT;
+		state[bestNode].schl = true;
+		update_frames(graph, state, delay, op_depth_v, LC, bestNode, queued);
 		iteration++;
 	}// end FDS-outer loop
-
-	DG.clear();
 }//end FDS function
 
 
 
 
-void getLCFDS(int& LC, double& latency_parameter, std::map<int, G_Node>& ops, std::vector<int>& delay)
+void getLCFDS(int& LC, double& latency_parameter, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay)
 {
-	int opn = ops.size();
+	int opn = graph.opn;
 	LC = 0;
 	//obtain ASAP latency first
 	for (auto i = 0; i < opn; i++)
-		if (ops[i].child.empty())
-			if (ops[i].asap + delay[ops[i].type] - 1 > LC)
-				LC = ops[i].asap + delay[ops[i].type] - 1;
+		if (graph.children(i).empty())
+			if (state[i].asap + delay[graph.type[i]] - 1 > LC)
+				LC = state[i].asap + delay[graph.type[i]] - 1;
 	LC *= latency_parameter;
 }
 
-void ASAPFDS(std::map<int, G_Node>& ops, std::vector<int>& delay)
+void ASAPFDS(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay)
 {
-	int opn = ops.size();
-	queue <G_Node*> q; //queue to read/update nodes' ASAP
+	int opn = graph.opn;
+	queue <int> q; //queue to read/update nodes' ASAP
 	for (auto i = 0; i < opn; i++)
 	{
-		ops[i].id = i; //initialize node id
-		ops[i].asap = -1; //initialize all node's asap to -1
-		ops[i].schl = false; //all nodes are not scheduled.
-		if (ops[i].parent.empty()) //push all input nodes into q (no parent)
+		state[i].asap = -1; //initialize all node's asap to -1
+		state[i].schl = false; //all nodes are not scheduled.
+		if (graph.parents(i).empty()) //push all input nodes into q (no parent)
 		{
-			ops[i].asap = 1; //input nodes have asap = 1
-			q.push(&ops[i]); //push all input nodes into q.
+			state[i].asap = 1; //input nodes have asap = 1
+			q.push(i); //push all input nodes into q.
 		}
 	}
-	G_Node* current = new G_Node; //temp node
+	int current = -1; //temp node
 	int temp = 0;
 	while (!q.empty())
 	{
 		current = q.front(); //read the head of q
-		if (current->asap > 0) //if head.asap > 0 (all visited), push all unvisited children into q.
+		if (state[current].asap > 0) //if head.asap > 0 (all visited), push all unvisited children into q.
 		{
-			for (auto it = current->child.begin(); it != current->child.end(); it++) //check all children and see if they can obtain ASAP and push into q
+			for (int child : graph.children(current)) //check all children and see if they can obtain ASAP and push into q
 			{
-				temp = checkParentFDS(*it, delay);
+				temp = checkParentFDS(child, graph, state, delay);
 				if (temp > 0) //all parent are visited (has > 0 T-asap, and then, return my Asap = max Parent Asap + d
 				{
-					(*it)->asap = temp; //get asap
-					q.push((*it)); //push into q
+					//the asap is final the first time it is obtained: push the child once, not once per visited parent
+					if (state[child].asap < 0)
+						q.push(child); //push into q
+					state[child].asap = temp; //get asap
 				}
 			}
 			q.pop(); //pop the current (head node)
@@ -468,23 +1006,23 @@ void ASAPFDS(std::map<int, G_Node>& ops, std::vector<int>& delay)
 	}
 
 	//for (int i = 0; i < opn; i++)
-		//cout << "my id: " << i << " , asap time = " << ops[i].asap << endl;
+		//cout << "my id: " << i << " , asap time = " << state[i].asap << endl;
 
 
 }
 
-int checkParentFDS(G_Node* op, std::vector<int>& delay)
+int checkParentFDS(int op, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay)
 {
 	bool test = false;
 	int myAsap = -1;
 
-	for (auto it = op->parent.begin(); it != op->parent.end(); it++)
+	for (int parent : graph.parents(op))
 	{
-		if ((*it)->asap > 0)
+		if (state[parent].asap > 0)
 		{
 			test = true;
-			if ((*it)->asap + delay[(*it)->type] > myAsap)
-				myAsap = (*it)->asap + delay[(*it)->type]; //my ASAP = parent.ASAP + delay
+			if (state[parent].asap + delay[graph.type[parent]] > myAsap)
+				myAsap = state[parent].asap + delay[graph.type[parent]]; //my ASAP = parent.ASAP + delay
 			continue;
 		}
 		else
@@ -497,34 +1035,36 @@ int checkParentFDS(G_Node* op, std::vector<int>& delay)
 	return myAsap;
 }
 
-void ALAPFDS(std::map<int, G_Node>& ops, std::vector<int>& delay, int& LC)
+void ALAPFDS(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC)
 {
-	int opn = ops.size();
-	queue <G_Node*> q; //same as obtain ASAP:
+	int opn = graph.opn;
+	queue <int> q; //same as obtain ASAP:
 	//push all output node into q first
 	for (auto i = 0; i < opn; i++)
 	{
-		ops[i].alap = LC + 1; //intialize > LC
-		if (ops[i].child.empty())
+		state[i].alap = LC + 1; //intialize > LC
+		if (graph.children(i).empty())
 		{
-			ops[i].alap = LC - delay[ops[i].type] + 1; //LC-Delay+1
-			q.push(&ops[i]); //push into q.
+			state[i].alap = LC - delay[graph.type[i]] + 1; //LC-Delay+1
+			q.push(i); //push into q.
 		}
 	}
-	G_Node* current = new G_Node;
+	int current = -1;
 	int temp = 0;
 	while (!q.empty())
 	{
 		current = q.front();
-		if (current->alap <= LC) //less than LC, the parent ALAP may be computed
+		if (state[current].alap <= LC) //less than LC, the parent ALAP may be computed
 		{
-			for (auto it = current->parent.begin(); it != current->parent.end(); it++)
+			for (int parent : graph.parents(current))
 			{
-				temp = checkChildFDS((*it), delay, LC);
+				temp = checkChildFDS(parent, graph, state, delay, LC);
 				if (temp <= LC) //my ALAP has been updated
 				{
-					(*it)->alap = temp;
-					q.push(*it);
+					//same as ASAP: the alap is final the first time it is obtained, push the parent once
+					if (state[parent].alap > LC)
+						q.push(parent);
+					state[parent].alap = temp;
 				}
 			}
 			q.pop();
@@ -532,17 +1072,17 @@ void ALAPFDS(std::map<int, G_Node>& ops, std::vector<int>& delay, int& LC)
 	}
 }
 
-int checkChildFDS(G_Node* op, std::vector<int>& delay, int& LC)
+int checkChildFDS(int op, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC)
 {
 	bool test = false;
 	int myAlap = LC + 1;
-	for (auto it = op->child.begin(); it != op->child.end(); it++)
+	for (int child : graph.children(op))
 	{
-		if ((*it)->alap <= LC)
+		if (state[child].alap <= LC)
 		{
 			test = true;
-			if ((*it)->alap - delay[op->type] <= myAlap)
-				myAlap = (*it)->alap - delay[op->type];
+			if (state[child].alap - delay[graph.type[op]] <= myAlap)
+				myAlap = state[child].alap - delay[graph.type[op]];
 			continue;
 		}
 		else
@@ -555,8 +1095,9 @@ int checkChildFDS(G_Node* op, std::vector<int>& delay, int& LC)
 	return myAlap;
 }
 
-void update_depth(std::map<int, int>& op_depth, vector<int>& topo_order, std::map<int, G_Node>& ops)
+void update_depth(std::map<int, int>& op_depth, vector<int>& topo_order, const DFGGraph& graph)
 {
+	int opn = graph.opn;
 
 	vector<vector<int>> G;
 	G.clear();
@@ -566,12 +1107,12 @@ void update_depth(std::map<int, int>& op_depth, vector<int>& topo_order, std::ma
 
 	for (auto i = 0; i < opn; i++) {
 
-		inDegree.push_back(ops[i].parent.size());
+		inDegree.push_back(graph.parents(i).size());
 
 		vector<int> temp;
-		for (auto su = ops[i].child.begin(); su != ops[i].child.end(); su++) {
+		for (int su : graph.children(i)) {
 
-			temp.push_back((*su)->id);
+			temp.push_back(su);
 		}
 
 		G.push_back(temp);
@@ -623,16 +1164,16 @@ void update_depth(std::map<int, int>& op_depth, vector<int>& topo_order, std::ma
 
 		//cout << *i << " ";
 
-		if (ops[*i].parent.size() == 0)
+		if (graph.parents(*i).size() == 0)
 			curr_depth[*i] = 1;
 
 		else {
 
 			int temp_max_depth = 0;
 
-			for (auto pr = ops[*i].parent.begin(); pr != ops[*i].parent.end(); pr++) {
+			for (int pr : graph.parents(*i)) {
 
-				int id = (*pr)->id;
+				int id = pr;
 
 				if (temp_max_depth < curr_depth[id])
 					temp_max_depth = curr_depth[id];
@@ -649,11 +1190,13 @@ void update_depth(std::map<int, int>& op_depth, vector<int>& topo_order, std::ma
 	op_depth = curr_depth;
 }
 
-void get_pr_su_update_list(std::map<int, G_Node>& ops, std::map<int, std::vector<int>>& ops_update_pr_list,
+void get_pr_su_update_list(const DFGGraph& graph, std::map<int, std::vector<int>>& ops_update_pr_list,
 	std::map<int, std::vector<int>>& ops_update_su_list,
 	std::map<int, int>& op_depth,
 	int& depth_limit)
 {
+	int opn = graph.opn;
+
 	ops_update_pr_list.clear();
 	ops_update_su_list.clear();
 
@@ -710,14 +1253,14 @@ void get_pr_su_update_list(std::map<int, G_Node>& ops, std::map<int, std::vector
 
 				//otherwise, process the header:
 				//scan header's pr list.
-				//adding pr into q and vector only if pr's depth = header's depth - 1.
-				for (auto pr = ops[header].parent.begin(); pr != ops[header].parent.end(); pr++)
+				//adding pr into q and vector only if pr's depth = header's depth - 1 (and once, a pr reached by several paths is not repeated).
+				for (int pr : graph.parents(header))
 				{
 					//get pr_id;
-					int pr_id = (*pr)->id;
+					int pr_id = pr;
 
 					//if header_depth - pr_depth = 1, add pr to both pr_q and vector.
-					if (header_depth - op_depth[pr_id] == 1)
+					if (header_depth - op_depth[pr_id] == 1 && std::find(pr_list.begin(), pr_list.end(), pr_id) == pr_list.end())
 					{
 						pr_list.push_back(pr_id);
 						pr_q.push(pr_id);
@@ -753,14 +1296,14 @@ void get_pr_su_update_list(std::map<int, G_Node>& ops, std::map<int, std::vector
 
 				//otherwise, process the header:
 				//scan header's su list.
-				//adding su into q and vector only if su's depth = header's depth + 1. //abs-difference = 1.
-				for (auto su = ops[header].child.begin(); su != ops[header].child.end(); su++)
+				//adding su into q and vector only if su's depth = header's depth + 1. //abs-difference = 1. Once per su.
+				for (int su : graph.children(header))
 				{
 					//get su_id;
-					int su_id = (*su)->id;
+					int su_id = su;
 
 					//if su_depth - header_depth = 1, add su to both pr_q and vector.
-					if ((op_depth[su_id] - header_depth) == 1)
+					if ((op_depth[su_id] - header_depth) == 1 && std::find(su_list.begin(), su_list.end(), su_id) == su_list.end())
 					{
 						su_list.push_back(su_id);
 						pr_q.push(su_id);
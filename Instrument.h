@@ -0,0 +1,149 @@
+#pragma once
+
+// Per-phase counters and timers of the list scheduler, aggregated per DFG and written as extra CSV columns.
+// They are only compiled in with -DLS_INSTRUMENT (./run_code.bash run --instrument); otherwise every INSTR_*
+// macro expands to nothing and instrument_columns() is empty, so the CSV files keep their usual columns.
+// The counters are per thread: the LS runs of worker threads (portfolio, multi-start) are added to the ones of the
+// thread that started them through an InstrCollector, once the workers are joined.
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct LSInstrument
+{
+	long long ls_calls = 0;				// LS() calls (1 for the base LS, 1 + one per target latency tried in LS_outer_loop)
+	long long outer_rounds = 0;			// latency ranges tried by LS_outer_loop (> 1 when the bounds had to be expanded)
+	long long cycles = 0;				// clock cycles simulated, over all LS() calls
+	long long ready_sets = 0;			// non-empty ready sets, one per (clock cycle, Function type)
+	long long ready_ops = 0;			// sum of the ready set sizes
+	long long max_ready = 0;			// largest ready set
+	long long priority_evals = 0;		// ready operations whose priorities were computed
+	long long sort_comparisons = 0;		// comparator calls while sorting the ready sets
+
+	double asap_alap_ms = 0;			// ASAP, latency constraint and ALAP
+	double ready_scan_ms = 0;			// search of the ready operations
+	double priority_ms = 0;				// calculate_priorities
+	double sort_ms = 0;					// sorting of the ready sets
+	double binding_ms = 0;				// scheduling and binding of the sorted ready operations
+};
+
+inline thread_local LSInstrument ls_instrument;
+
+inline void instrument_add(LSInstrument& into, const LSInstrument& from)
+{
+	into.ls_calls += from.ls_calls;
+	into.outer_rounds += from.outer_rounds;
+	into.cycles += from.cycles;
+	into.ready_sets += from.ready_sets;
+	into.ready_ops += from.ready_ops;
+	into.max_ready = std::max(into.max_ready, from.max_ready);
+	into.priority_evals += from.priority_evals;
+	into.sort_comparisons += from.sort_comparisons;
+	into.asap_alap_ms += from.asap_alap_ms;
+	into.ready_scan_ms += from.ready_scan_ms;
+	into.priority_ms += from.priority_ms;
+	into.sort_ms += from.sort_ms;
+	into.binding_ms += from.binding_ms;
+}
+
+// Counters of the jobs of a parallel_for: created on the calling thread, collect() at the end of every job takes
+// the counters of a worker thread, merge() after parallel_for adds them to the ones of the calling thread (whose own
+// jobs already count there).
+class InstrCollector
+{
+public:
+	InstrCollector() : owner(&ls_instrument) {}
+
+	void collect()
+	{
+#ifdef LS_INSTRUMENT
+		if (&ls_instrument == owner)
+			return;
+		std::lock_guard<std::mutex> lock(mutex);
+		instrument_add(workers, ls_instrument);
+		ls_instrument = LSInstrument();
+#endif
+	}
+
+	void merge()
+	{
+#ifdef LS_INSTRUMENT
+		instrument_add(*owner, workers);
+		workers = LSInstrument();
+#endif
+	}
+
+private:
+	LSInstrument* owner;
+	LSInstrument workers;
+	std::mutex mutex;
+};
+
+// Adds the time spent in its scope to the given total (in ms)
+class InstrTimer
+{
+public:
+	explicit InstrTimer(double& total_ms) : total(total_ms), start(std::chrono::steady_clock::now()) {}
+	~InstrTimer()
+	{
+		total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+private:
+	double& total;
+	std::chrono::steady_clock::time_point start;
+};
+
+#ifdef LS_INSTRUMENT
+#define INSTR_ADD(counter, n)	(ls_instrument.counter += (n))
+#define INSTR_MAX(counter, v)	(ls_instrument.counter = std::max<long long>(ls_instrument.counter, (v)))
+#define INSTR_TIMER(phase)		InstrTimer instr_timer_##phase(ls_instrument.phase##_ms)
+#else
+#define INSTR_ADD(counter, n)	((void)0)
+#define INSTR_MAX(counter, v)	((void)0)
+#define INSTR_TIMER(phase)		((void)0)
+#endif
+
+inline void instrument_reset()
+{
+	ls_instrument = LSInstrument();
+}
+
+// (header, value) pairs appended after Runtime_ms in the CSV files
+inline std::vector<std::pair<std::string, std::string>> instrument_columns()
+{
+	std::vector<std::pair<std::string, std::string>> columns;
+
+#ifdef LS_INSTRUMENT
+	const LSInstrument& s = ls_instrument;
+
+	auto num = [](double v) {
+		std::ostringstream out;
+		out << v;
+		return out.str();
+	};
+
+	double avg_ready = s.ready_sets > 0 ? static_cast<double>(s.ready_ops) / s.ready_sets : 0;
+
+	columns.push_back(std::make_pair("LS_Calls", std::to_string(s.ls_calls)));
+	columns.push_back(std::make_pair("Outer_Rounds", std::to_string(s.outer_rounds)));
+	columns.push_back(std::make_pair("Cycles", std::to_string(s.cycles)));
+	columns.push_back(std::make_pair("Ready_Sets", std::to_string(s.ready_sets)));
+	columns.push_back(std::make_pair("Avg_Ready", num(avg_ready)));
+	columns.push_back(std::make_pair("Max_Ready", std::to_string(s.max_ready)));
+	columns.push_back(std::make_pair("Priority_Evals", std::to_string(s.priority_evals)));
+	columns.push_back(std::make_pair("Sort_Comparisons", std::to_string(s.sort_comparisons)));
+	columns.push_back(std::make_pair("ASAP_ALAP_ms", num(s.asap_alap_ms)));
+	columns.push_back(std::make_pair("Ready_Scan_ms", num(s.ready_scan_ms)));
+	columns.push_back(std::make_pair("Priority_ms", num(s.priority_ms)));
+	columns.push_back(std::make_pair("Sort_ms", num(s.sort_ms)));
+	columns.push_back(std::make_pair("Binding_ms", num(s.binding_ms)));
+#endif
+
+	return columns;
+}
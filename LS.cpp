@@ -1,4 +1,8 @@
 #include "LS.h"
+#include "Instrument.h"
+#include "Trace.h"
+#include "Perf.h"
+#include "LowerBound.h"
 
 using namespace std;
 
@@ -23,8 +27,11 @@ struct preAllocation		//allocation
 
 
 struct SortSlack {
-	bool operator()(const std::pair<int, G_Node>& a, const std::pair<int, G_Node>& b) {
-		return a.second.alap < b.second.alap;
+	bool operator()(const std::pair<int, NodeState*>& a, const std::pair<int, NodeState*>& b) {
+		INSTR_ADD(sort_comparisons, 1);
+		if (a.second->alap != b.second->alap)
+			return a.second->alap < b.second->alap;
+		return a.second->tie < b.second->tie;
 	}
 };
 
@@ -39,17 +46,24 @@ struct PrioritySorting {
 
 	PrioritySorting(bool active) : use_featS(active) {}
 
-	bool operator()(const std::pair<int, G_Node>& a, const std::pair<int, G_Node>& b) {
+	bool operator()(const std::pair<int, NodeState*>& a, const std::pair<int, NodeState*>& b) {
+		INSTR_ADD(sort_comparisons, 1);
 		
-		if (a.second.priority1 != b.second.priority1) {
-            return a.second.priority1 < b.second.priority1;
+		if (a.second->priority1 != b.second->priority1) {
+            return a.second->priority1 < b.second->priority1;
         }
 
-		if (use_featS) {
+		if (use_featS && a.second->priority3 != b.second->priority3) {
 
-			return a.second.priority3 < b.second.priority3;
+			return a.second->priority3 < b.second->priority3;
 		}
 
+		if (a.second->tie != b.second->tie)
+			return a.second->tie < b.second->tie;
+
+		if (use_featS)
+			return false;
+
 		return a.first < b.first;
 
 	}
@@ -58,37 +72,69 @@ struct PrioritySorting {
 // END OF SILVIA'S NEW IMPROVEMENT IDEA
 
 
+// Resource pre-analysis of LS(), from the ASAP schedule of the DFG
+struct ResourceProfile
+{
+	vector<int> ops;			//# of ops of each Function type
+	vector<int> asap_peak;		//max # of ops of each type executing in the same cc of the ASAP schedule
+	vector<char> slack;			//constraint >= # of ops of the type: an op of the type never waits for an FU
+	bool all_slack = false;		//asap_peak <= constraint for every type: the ASAP schedule meets the constraints
+	vector<int> usage;			//scratch: ops of each type starting (+1) and finishing (-1) in each cc
+};
+
+
+// Buffers of LS(), kept from one call to the next (and from one DFG to the next) on the same thread:
+// once they have grown to the size of the DFG, the repeated LS() calls of LS_outer_loop do not allocate.
+struct LSWorkspace
+{
+	Sclbld sclbld;
+	vector<preAllocation> Allocation;
+	vector<int> availableOperations;					//available non-0 slack operations in current clock cycle
+	vector<vector<int>> time;							//time[Function type][an FU] saves the finishing cc of each allocated FU
+	vector<std::pair<int, NodeState*>> tempOpSet;		//available operations of the current Function type, with their state
+	vector<NodeState> state;							//values of each operation in the current run (ASAP, ALAP, priorities)
+	ResourceProfile profile;							//per-type parallelism of the ASAP schedule
+	vector<int> asapOrder;								//operations in the order the ASAP schedule binds them
+};
+
+static thread_local LSWorkspace ls_workspace;
+
+thread_local const std::atomic<bool>* schedule_cancel = nullptr;
+thread_local LSPerturbation* ls_perturbation = nullptr;
+
 
 //functions to check ASAP, ALAP, get latency constraint.
-void ASAP(std::map<int, G_Node>& ops, std::vector<int>& delay);
-int checkParent(G_Node* op, std::vector<int>& delay);
-void ALAP(std::map<int, G_Node>& ops, std::vector<int>& delay, int& LC);
-int checkChild(G_Node* op, std::vector<int>& delay, int& LC);
-void getLC(int& LC, double& latency_parameter, std::map<int, G_Node>& ops, std::vector<int>& delay);
+void ASAP(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay);
+int checkParent(int op, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay);
+void ALAP(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC);
+int checkChild(int op, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC);
+void getLC(int& LC, double& latency_parameter, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay);
+void AnalyzeResources(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay, const std::vector<int>& res_constr, ResourceProfile& profile);
 
 
 
 // IMPLEMENTED BY PLEASE
-void calculate_first_priority(std::vector<std::pair<int, G_Node>>& available_ops, std::map<int, G_Node>& ops, std::vector<int>& delay, bool debug, bool featP, bool featS);
+void calculate_first_priority(std::vector<std::pair<int, NodeState*>>& available_ops, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, bool debug, bool featP, bool featS);
 // END IMPLEMENTED BY PLEASE
 
 
 
 // IMPLEMENTED BY SILVIA
 void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
-	std::map<int, G_Node>& ops, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP);
-void calculate_priorities(std::vector<std::pair<int, G_Node>>& available_ops, std::map<int, G_Node>& ops, std::vector<int>& delay, bool debug, bool featP, bool featS);
-void calculate_second_priority(std::vector<std::pair<int, G_Node>>& available_ops, std::map<int, G_Node>& ops, std::vector<int>& delay);
-void calculate_third_priority(std::vector<std::pair<int, G_Node>>& available_ops, std::map<int, G_Node>& ops, std::vector<int>& delay);
-int ASAP_latency(std::map<int, G_Node>& ops, std::vector<int>& delay);
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP);
+void calculate_priorities(std::vector<std::pair<int, NodeState*>>& available_ops, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, bool debug, bool featP, bool featS);
+void calculate_second_priority(std::vector<std::pair<int, NodeState*>>& available_ops, const DFGGraph& graph, std::vector<int>& delay);
+void calculate_third_priority(std::vector<std::pair<int, NodeState*>>& available_ops, const DFGGraph& graph, std::vector<int>& delay);
+int ASAP_latency(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay);
 // END IMPLEMENTED BY SILVIA
 
 
 
 // IMPLEMENTED BY SILVIA
 void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
-	std::map<int, G_Node>& ops, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool featS, bool featP)
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool featS, bool featP)
 {
+	TRACE_SCOPE("LS_outer_loop", "ls");
 
 	int target_latency, current_run_latency, best_latency;
 	bool at_least_one_success, first_iteration, valid_schedule_found;
@@ -96,12 +142,18 @@ void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocat
 
 	// Calculate latency upper bound
     LS(schlResult, FUAllocationResult, bindingResult, actualLatency,
-			ops, latencyConstraint, latencyParameter, delay, res_constr, false, debug, false, false);
+			graph, latencyConstraint, latencyParameter, delay, res_constr, false, debug, false, false);
 
-	int upper_bound_latency = actualLatency * latencyParameter;
+	// every constraint is slack: LS() returned the ASAP schedule, whose latency is the lower bound
+	if (ls_workspace.profile.all_slack) {
+		if (debug) cout << "Resource constraints are not binding, ASAP schedule with latency " << actualLatency << endl;
+		return;
+	}
+
+	// Calculate latency lower bound: no schedule meeting the resource constraints is shorter, the search stops there
+	int lower_bound_latency = latency_lower_bound(graph, delay, res_constr).latency;
 
-	// Calculate latency lower bound 
-	int lower_bound_latency = ASAP_latency(ops, delay);
+	int upper_bound_latency = actualLatency * latencyParameter;
 
 	// Temporary storage for the best found solution
 	std::map<int, int> temp_schlResult;
@@ -117,6 +169,7 @@ void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocat
 
 	at_least_one_success = false;
 	do {
+		INSTR_ADD(outer_rounds, 1);
 		
 		int target_latency = upper_bound_latency; 
         bool first_iteration = true;
@@ -137,10 +190,13 @@ void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocat
 
 			if (debug) cout << "Attempting target: " << target_latency << endl; 
 
+			TraceScope attempt_trace("attempt", "ls");
+			attempt_trace.arg("target_latency", target_latency);
+
 			// calculate priorities
 
 			LS(schlResult, FUAllocationResult, bindingResult, current_run_latency,
-				ops, target_latency, latencyParameter, delay, res_constr, true, debug, featS, featP);
+				graph, target_latency, latencyParameter, delay, res_constr, true, debug, featS, featP);
 
 			valid_schedule_found = (current_run_latency > 0 && current_run_latency <= target_latency);
 
@@ -152,16 +208,21 @@ void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocat
 				at_least_one_success = true;
 				target_latency = current_run_latency;
 
-				// Store best found solution
+				// Store best found solution: swap instead of copy, the next LS() overwrites every entry it reports
 				best_latency = current_run_latency;
-				temp_schlResult = schlResult;
-				temp_FUAllocationResult = FUAllocationResult;
-				temp_bindingResult = bindingResult;
+				temp_schlResult.swap(schlResult);
+				temp_FUAllocationResult.swap(FUAllocationResult);
+				temp_bindingResult.swap(bindingResult);
 			} else {
 				if (debug) cout << "No valid schedule found for target latency: " << target_latency << endl;
 			}
 
-		} while (valid_schedule_found && target_latency > lower_bound_latency);
+		} while (valid_schedule_found && target_latency > lower_bound_latency && !schedule_cancelled());
+
+		if (!at_least_one_success && schedule_cancelled()) {
+			actualLatency = 0;	//cancelled before any valid schedule
+			return;
+		}
 
 		if (!at_least_one_success){
 
@@ -175,9 +236,9 @@ void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocat
 
 		
 	// Revert to best found solution
-	schlResult = temp_schlResult;
-	FUAllocationResult = temp_FUAllocationResult;
-	bindingResult = temp_bindingResult;
+	schlResult.swap(temp_schlResult);
+	FUAllocationResult.swap(temp_FUAllocationResult);
+	bindingResult.swap(temp_bindingResult);
 
 	actualLatency = best_latency;
 
@@ -187,43 +248,71 @@ void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocat
 
 
 void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
-	std::map<int, G_Node>& ops, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP)
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP)
 {
-	ASAP(ops, delay);
+	INSTR_ADD(ls_calls, 1);
+
+	TraceScope ls_trace("LS", "ls");
+	ls_trace.arg("improved", improvedSolution);
+	PERF_SCOPE(PERF_LS);
+
+	// buffers reused from the previous call on this thread
+	LSWorkspace& ws = ls_workspace;
+	Sclbld& sclbld = ws.sclbld;
+
+	int opn = graph.opn; //# of operations in this DFG.
+
+	//per-run values of the operations: graph itself is never written
+	vector<NodeState>& state = ws.state;
+	state.assign(opn, NodeState());
+
+	{
+	INSTR_TIMER(asap_alap);
+
+	ASAP(graph, state, delay);
 
 	
 	// CHANGED BY SILVIA
 	if (!improvedSolution) {
-        getLC(latencyConstraint, latencyParameter, ops, delay);
+        getLC(latencyConstraint, latencyParameter, graph, state, delay);
     }
 	// END CHANGED BY SILVIA
 
 
-	ALAP(ops, delay, latencyConstraint);
+	ALAP(graph, state, delay, latencyConstraint);
+	}
 
 	// print the whole content of ops for debugging
 	if (debug)
-	for (const auto& [id, node] : ops) {
-		std::cout << "Node ID: " << id << ", Type: " << node.type
-			<< ", ASAP: " << node.asap << ", ALAP: " << node.alap << "\n";
+	for (int id = 0; id < opn; id++) {
+		std::cout << "Node ID: " << id << ", Type: " << graph.type[id]
+			<< ", ASAP: " << state[id].asap << ", ALAP: " << state[id].alap << "\n";
 	}
 
 	// CHANGED BY SILVIA
 	int numberOfFunctionType = res_constr.size();
 	// END CHANGED BY SILVIA
 
-	Sclbld sclbld;
+	ResourceProfile& profile = ws.profile;
+	AnalyzeResources(graph, state, delay, res_constr, profile);
 
-	int opn = ops.size(); //# of operations in this DFG.
+	if (debug) {
+		for (int t = 0; t < numberOfFunctionType; t++)
+			cout << "Type " << t << ": " << profile.ops[t] << " ops, ASAP peak " << profile.asap_peak[t] << ", constraint " << res_constr[t]
+				<< (profile.slack[t] ? " (never binding)" : "") << endl;
+		if (profile.all_slack)
+			cout << "No binding constraint: ASAP schedule" << endl;
+	}
 
-	vector<preAllocation> Allocation;
+	vector<preAllocation>& Allocation = ws.Allocation;
+	Allocation.clear();
 
 	//initialize the allocation structure: only Function types appearing in the DFG are considered
 	for (int anOperation = 0; anOperation < opn; anOperation++)
 	{
 		auto pt = Allocation.begin();
 		for (; pt != Allocation.end(); pt++)
-			if (pt->FunctionType == ops[anOperation].type)
+			if (pt->FunctionType == graph.type[anOperation])
 				break;
 
 		//a new Function type needs to be considered in the allocation structure
@@ -232,7 +321,7 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 
 
 			preAllocation instance;
-            instance.FunctionType = ops[anOperation].type;
+            instance.FunctionType = graph.type[anOperation];
             
             // IMPLEMENTED BY SILVIA
             
@@ -253,8 +342,10 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 	}
 
 	int currentClockCycle;
-	vector<int> availableOperations;					//available non-0 slack operations in current clock cycle
-	vector<vector<int>> time(numberOfFunctionType);	//time[Function type][an FU] saves the finishing cc of each allocated FU
+	vector<int>& availableOperations = ws.availableOperations;	//available non-0 slack operations in current clock cycle
+	vector<vector<int>>& time = ws.time;						//time[Function type][an FU] saves the finishing cc of each allocated FU
+	availableOperations.clear();
+	time.resize(numberOfFunctionType);
 
 	currentClockCycle = 1;
 	sclbld.scl.assign(opn, 0);
@@ -263,7 +354,14 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 	sclbld.res.assign(numberOfFunctionType, 0);
 	// END CHANGED BY SILVIA
 
-	sclbld.bld = vector<vector<vector<int>>>(numberOfFunctionType, vector<vector<int>>(1, vector<int>(0)));
+	//at least one (empty) FU per Function type; FUs left over from a previous call are emptied and stay unused
+	sclbld.bld.resize(numberOfFunctionType);
+	for (auto& fus : sclbld.bld) {
+		if (fus.empty())
+			fus.resize(1);
+		for (auto& boundOps : fus)
+			boundOps.clear();
+	}
 
 
 	// IMPLEMENTED BY SILVIA
@@ -314,33 +412,74 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 	//initialize allocation
 	for (auto spt = Allocation.begin(); spt != Allocation.end(); spt++)
 	{
-		for (int i = 0; i < spt->preNum - 1; i++)	//there is one FU allocated for each Function type at the beginning
-			sclbld.bld[spt->FunctionType].push_back(vector<int>(0));
+		if (static_cast<int>(sclbld.bld[spt->FunctionType].size()) < spt->preNum)	//there is one FU allocated for each Function type at the beginning
+			sclbld.bld[spt->FunctionType].resize(spt->preNum);
 		spt->postNum = spt->preNum;
 		spt->utilizationRate = 0;
 	}
 
 	int numberOfScheduledOperations = 0;		//number of scheduled operations
+
+	//no constraint is binding: every operation gets an FU at its ASAP cc, only the binding is left to do.
+	//Same FU choice as the list scheduling below, operations of a cc and type in increasing slack order
+	if (profile.all_slack)
+	{
+		vector<int>& asapOrder = ws.asapOrder;
+		asapOrder.resize(opn);
+		for (int op = 0; op < opn; op++)
+			asapOrder[op] = op;
+		std::sort(asapOrder.begin(), asapOrder.end(), [&](int a, int b) {
+			if (state[a].asap != state[b].asap)
+				return state[a].asap < state[b].asap;
+			if (graph.type[a] != graph.type[b])
+				return graph.type[a] < graph.type[b];
+			if (state[a].alap != state[b].alap)
+				return state[a].alap < state[b].alap;
+			return a < b;
+		});
+
+		INSTR_TIMER(binding);
+		for (int op_id : asapOrder) {
+			int opType = graph.type[op_id];
+			for (size_t k = 0; k < time[opType].size(); k++){
+				if (time[opType][k] < state[op_id].asap)
+				{
+					sclbld.scl[op_id] = state[op_id].asap;
+					numberOfScheduledOperations++;
+					sclbld.bld[opType][k].push_back(op_id);
+					time[opType][k] = state[op_id].asap + delay[opType] - 1;
+					break;
+				}
+			}
+		}
+	}
+
 	while (numberOfScheduledOperations != opn)	//list scheduling begins
 	{
+		INSTR_ADD(cycles, 1);
+
 		for (int currentFunctionType = 0; currentFunctionType < numberOfFunctionType; currentFunctionType++)	//for each Function type
 		{
+			{
+			INSTR_TIMER(ready_scan);
+
 			for (int currentOperation = 0; currentOperation < opn; currentOperation++)	//for each operation
 			{
 				//choose an unscheduled operation of the current Function type
-				if ((ops[currentOperation].type == currentFunctionType) && (sclbld.scl[currentOperation] == 0))
+				if ((graph.type[currentOperation] == currentFunctionType) && (sclbld.scl[currentOperation] == 0))
 				{
 					//check whether the chosen operation is available (an operation is considered to be available if it has no unscheduled parents
-					auto pt = ops[currentOperation].parent.begin();
-					if (ops[currentOperation].parent.size() > 0)
-						for (; pt != ops[currentOperation].parent.end(); pt++)
+					DFGGraph::IdRange parents = graph.parents(currentOperation);
+					auto pt = parents.begin();
+					if (parents.size() > 0)
+						for (; pt != parents.end(); pt++)
 							//the parent operation has not been scheduled or its finish cc (the node has been scheduled) is greater than current cc which means the operation is still unavailable
-							if ((sclbld.scl[(*pt)->id] == 0) || (sclbld.scl[(*pt)->id] + delay[ops[(*pt)->id].type] > currentClockCycle))
+							if ((sclbld.scl[*pt] == 0) || (sclbld.scl[*pt] + delay[graph.type[*pt]] > currentClockCycle))
 								break;
 					bool operationAvailability = false;
-					if (ops[currentOperation].parent.size() > 0)	//the current operation has parent(s)
+					if (parents.size() > 0)	//the current operation has parent(s)
 					{
-						if (pt == ops[currentOperation].parent.end())
+						if (pt == parents.end())
 							operationAvailability = true;
 					}
 					//the current operation has no parent, means the current operation is available for sure
@@ -351,24 +490,41 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 					if (operationAvailability) availableOperations.push_back(currentOperation);
 				}//end operation and Function type matching
 			}//end each current operation
+			}
 
 			//Schedule them to available FUs in increasing slack order
 			if (!availableOperations.empty())
 			{
-				vector<std::pair<int, G_Node>> tempOpSet;
+				INSTR_ADD(ready_sets, 1);
+				INSTR_ADD(ready_ops, availableOperations.size());
+				INSTR_MAX(max_ready, availableOperations.size());
+
+				vector<std::pair<int, NodeState*>>& tempOpSet = ws.tempOpSet;
 				tempOpSet.clear();
 
 				for (auto it = availableOperations.begin(); it != availableOperations.end(); it++)
-					tempOpSet.push_back(std::make_pair((*it), ops[*it]));
+					tempOpSet.push_back(std::make_pair((*it), &state[*it]));
+
+				//multi-start: a new random order among the ops the priorities leave tied
+				if (ls_perturbation)
+					for (auto& entry : tempOpSet)
+						entry.second->tie = ls_perturbation->rng();
 
 
 
 				// IMPLEMENTED BY SILVIA
 
 				// Calculate priorities for available operations
-				if (improvedSolution) {
+				if (profile.slack[currentFunctionType]) {
+					//enough FUs for all the operations of the type: each one is bound in the cc it becomes available,
+					//whatever the order, so there is nothing to rank
+				} else if (improvedSolution) {
 					
-					calculate_priorities(tempOpSet, ops, delay, debug, featP, featS);
+					{
+					INSTR_TIMER(priority);
+					INSTR_ADD(priority_evals, tempOpSet.size());
+					calculate_priorities(tempOpSet, graph, state, delay, debug, featP, featS);
+					}
 
 					// Debug info
 
@@ -379,7 +535,7 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 
 						for (const auto& p : tempOpSet) {
 							// Access the node from the pair
-							const G_Node& n = p.second; 
+							const NodeState& n = *p.second; 
 							cout << p.first << "\t" 
 								<< n.priority1 << "\t\t" 
 								<< n.priority2 << "\t\t" 
@@ -389,10 +545,16 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 					}
 
 					//sort operations in increasing Priority order
+					{
+					INSTR_TIMER(sort);
 					std::sort(tempOpSet.begin(), tempOpSet.end(), PrioritySorting(featS));
+					}
 				} else {
 					//sort operations in increasing slack order
+					{
+					INSTR_TIMER(sort);
 					std::sort(tempOpSet.begin(), tempOpSet.end(), SortSlack());
+					}
 					if (debug)
 					{
 						// print tempopset sorted by slack
@@ -401,7 +563,7 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 						cout << "ID\tASAP\tALAP\tSlack" << endl;
 						for (const auto& p : tempOpSet) {
 							// Access the node from the pair
-							const G_Node& n = p.second;
+							const NodeState& n = *p.second;
 							int slack = n.alap - n.asap;
 							cout << p.first << "\t" 
 								<< n.asap << "\t" 
@@ -415,6 +577,7 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 
 
 				//schedule avaialble operations in increasing slack order and bind them to avaialble FUs
+				INSTR_TIMER(binding);
 				for (auto it = tempOpSet.begin(); it != tempOpSet.end(); it++){
 
 					int op_id = it->first;
@@ -425,7 +588,7 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 							sclbld.scl[op_id] = currentClockCycle;
 							numberOfScheduledOperations++;
 							sclbld.bld[currentFunctionType][k].push_back(op_id);
-							time[currentFunctionType][k] = currentClockCycle + delay[ops[op_id].type] - 1;
+							time[currentFunctionType][k] = currentClockCycle + delay[graph.type[op_id]] - 1;
 
 							if (debug) {
                                 cout << " => [ASSIGNED] Cycle " << currentClockCycle 
@@ -447,8 +610,8 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 	//get achieved latency of the LS iteration
 	sclbld.achievedLatency = 0;
 	for (int anOperation = 0; anOperation < opn; anOperation++)
-		if (sclbld.achievedLatency < sclbld.scl[anOperation] + delay[ops[anOperation].type] - 1)
-			sclbld.achievedLatency = sclbld.scl[anOperation] + delay[ops[anOperation].type] - 1;
+		if (sclbld.achievedLatency < sclbld.scl[anOperation] + delay[graph.type[anOperation]] - 1)
+			sclbld.achievedLatency = sclbld.scl[anOperation] + delay[graph.type[anOperation]] - 1;
 
 	//get output results:
 	//schl result
@@ -460,9 +623,12 @@ void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult,
 		FUAllocationResult[t] = sclbld.res[t];
 
 	//FU binding result
-	for (auto t = 0; t < numberOfFunctionType; t++)
+	for (auto t = 0; t < numberOfFunctionType; t++) {
 		for (auto i = 0; i < FUAllocationResult[t]; i++)
 			bindingResult[t][i] = sclbld.bld[t][i];
+		//drop the FUs of an earlier, larger allocation (the maps are reused by LS_outer_loop)
+		bindingResult[t].erase(bindingResult[t].lower_bound(FUAllocationResult[t]), bindingResult[t].end());
+	}
 
 	actualLatency = sclbld.achievedLatency;
 }
@@ -524,47 +690,48 @@ void print_fds(const std::vector<std::vector<float>>& fds_graphs, int target_lat
 
 
 
-void getLC(int& LC, double& latency_parameter, std::map<int, G_Node>& ops, std::vector<int>& delay)
+void getLC(int& LC, double& latency_parameter, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay)
 {
-	int opn = ops.size();
+	int opn = graph.opn;
 	LC = 0;
 	//obtain ASAP latency first
 	for (auto i = 0; i < opn; i++)
-		if (ops[i].child.empty())
-			if (ops[i].asap + delay[ops[i].type] - 1 > LC)
-				LC = ops[i].asap + delay[ops[i].type] - 1;
+		if (graph.children(i).empty())
+			if (state[i].asap + delay[graph.type[i]] - 1 > LC)
+				LC = state[i].asap + delay[graph.type[i]] - 1;
 	LC *= latency_parameter;
 }
 
-void ASAP(std::map<int, G_Node>& ops, std::vector<int>& delay)
+void ASAP(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay)
 {
-	int opn = ops.size();
-	queue <G_Node*> q; //queue to read/update nodes' ASAP
+	int opn = graph.opn;
+	queue <int> q; //queue to read/update nodes' ASAP
 	for (auto i = 0; i < opn; i++)
 	{
-		ops[i].id = i; //initialize node id
-		ops[i].asap = -1; //initialize all node's asap to -1
-		ops[i].schl = false; //all nodes are not scheduled.
-		if (ops[i].parent.empty()) //push all input nodes into q (no parent)
+		state[i].asap = -1; //initialize all node's asap to -1
+		state[i].schl = false; //all nodes are not scheduled.
+		if (graph.parents(i).empty()) //push all input nodes into q (no parent)
 		{
-			ops[i].asap = 1; //input nodes have asap = 1
-			q.push(&ops[i]); //push all input nodes into q.
+			state[i].asap = 1; //input nodes have asap = 1
+			q.push(i); //push all input nodes into q.
 		}
 	}
-	G_Node* current = new G_Node; //temp node
+	int current = -1; //temp node
 	int temp = 0;
 	while (!q.empty())
 	{
 		current = q.front(); //read the head of q
-		if (current->asap > 0) //if head.asap > 0 (all visited), push all unvisited children into q.
+		if (state[current].asap > 0) //if head.asap > 0 (all visited), push all unvisited children into q.
 		{
-			for (auto it = current->child.begin(); it != current->child.end(); it++) //check all children and see if they can obtain ASAP and push into q
+			for (int child : graph.children(current)) //check all children and see if they can obtain ASAP and push into q
 			{
-				temp = checkParent(*it, delay);
+				temp = checkParent(child, graph, state, delay);
 				if (temp > 0) //all parent are visited (has > 0 T-asap, and then, return my Asap = max Parent Asap + d
 				{
-					(*it)->asap = temp; //get asap
-					q.push((*it)); //push into q
+					//the asap is final the first time it is obtained: push the child once, not once per visited parent
+					if (state[child].asap < 0)
+						q.push(child); //push into q
+					state[child].asap = temp; //get asap
 				}
 			}
 			q.pop(); //pop the current (head node)
@@ -573,18 +740,18 @@ void ASAP(std::map<int, G_Node>& ops, std::vector<int>& delay)
 
 }
 
-int checkParent(G_Node* op, std::vector<int>& delay)
+int checkParent(int op, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay)
 {
 	bool test = false;
 	int myAsap = -1;
 
-	for (auto it = op->parent.begin(); it != op->parent.end(); it++)
+	for (int parent : graph.parents(op))
 	{
-		if ((*it)->asap > 0)
+		if (state[parent].asap > 0)
 		{
 			test = true;
-			if ((*it)->asap + delay[(*it)->type] > myAsap)
-				myAsap = (*it)->asap + delay[(*it)->type]; //my ASAP = parent.ASAP + delay
+			if (state[parent].asap + delay[graph.type[parent]] > myAsap)
+				myAsap = state[parent].asap + delay[graph.type[parent]]; //my ASAP = parent.ASAP + delay
 			continue;
 		}
 		else
@@ -597,34 +764,36 @@ int checkParent(G_Node* op, std::vector<int>& delay)
 	return myAsap;
 }
 
-void ALAP(std::map<int, G_Node>& ops, std::vector<int>& delay, int& LC)
+void ALAP(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC)
 {
-	int opn = ops.size();
-	queue <G_Node*> q; //same as obtain ASAP:
+	int opn = graph.opn;
+	queue <int> q; //same as obtain ASAP:
 	//push all output node into q first
 	for (auto i = 0; i < opn; i++)
 	{
-		ops[i].alap = LC + 1; //intialize > LC
-		if (ops[i].child.empty())
+		state[i].alap = LC + 1; //intialize > LC
+		if (graph.children(i).empty())
 		{
-			ops[i].alap = LC - delay[ops[i].type] + 1; //LC-Delay+1
-			q.push(&ops[i]); //push into q.
+			state[i].alap = LC - delay[graph.type[i]] + 1; //LC-Delay+1
+			q.push(i); //push into q.
 		}
 	}
-	G_Node* current = new G_Node;
+	int current = -1;
 	int temp = 0;
 	while (!q.empty())
 	{
 		current = q.front();
-		if (current->alap <= LC) //less than LC, the parent ALAP may be computed
+		if (state[current].alap <= LC) //less than LC, the parent ALAP may be computed
 		{
-			for (auto it = current->parent.begin(); it != current->parent.end(); it++)
+			for (int parent : graph.parents(current))
 			{
-				temp = checkChild((*it), delay, LC);
+				temp = checkChild(parent, graph, state, delay, LC);
 				if (temp <= LC) //my ALAP has been updated
 				{
-					(*it)->alap = temp;
-					q.push(*it);
+					//same as ASAP: the alap is final the first time it is obtained, push the parent once
+					if (state[parent].alap > LC)
+						q.push(parent);
+					state[parent].alap = temp;
 				}
 			}
 			q.pop();
@@ -632,21 +801,21 @@ void ALAP(std::map<int, G_Node>& ops, std::vector<int>& delay, int& LC)
 	}
 }
 
-int checkChild(G_Node* op, std::vector<int>& delay, int& LC)
+int checkChild(int op, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC)
 {
 	bool test = false;
 	int myAlap = LC + 1;
 	int criticalChildId = -1;
-	for (auto it = op->child.begin(); it != op->child.end(); it++)
+	for (int child : graph.children(op))
 	{
-		if ((*it)->alap <= LC)
+		if (state[child].alap <= LC)
 		{
 			test = true;
-			if ((*it)->alap - delay[op->type] <= myAlap){
-				myAlap = (*it)->alap - delay[op->type];
+			if (state[child].alap - delay[graph.type[op]] <= myAlap){
+				myAlap = state[child].alap - delay[graph.type[op]];
 
 				// IMPLEMENTED BY SILVIA
-				op->criticalSuccessorId = (*it)->id;
+				state[op].criticalSuccessorId = child;
 				// END IMPLEMENTED BY SILVIA
 			}
 			continue;
@@ -663,7 +832,7 @@ int checkChild(G_Node* op, std::vector<int>& delay, int& LC)
 
 
 // IMPLEMENTED BY SILVIA
-void calculate_fds_graphs(std::map<int, G_Node> ops, std::vector<std::vector<float>>& fds_graphs, int target_latency, std::vector<int> delay, bool debug)
+void calculate_fds_graphs(const DFGGraph& graph, const std::vector<NodeState>& state, std::vector<std::vector<float>>& fds_graphs, int target_latency, const std::vector<int>& delay, bool debug)
 { 
 
 	
@@ -673,12 +842,12 @@ void calculate_fds_graphs(std::map<int, G_Node> ops, std::vector<std::vector<flo
 
 
 	// Compute probabilities
-	for (const auto& [id, node] : ops) {
+	for (int id = 0; id < graph.opn; id++) {
 
 		// Get node info 
-		int func_type = node.type;
-		int asap_time = node.asap;
-		int alap_time = node.alap;
+		int func_type = graph.type[id];
+		int asap_time = state[id].asap;
+		int alap_time = state[id].alap;
 
 		// Get operation latency
 		int op_latency = delay[func_type];
@@ -708,30 +877,35 @@ void calculate_fds_graphs(std::map<int, G_Node> ops, std::vector<std::vector<flo
 }
 
 
-void calculate_priorities(std::vector<std::pair<int, G_Node>>& available_ops, std::map<int, G_Node>& ops, std::vector<int>& delay, bool debug, bool featP, bool featS)
+void calculate_priorities(std::vector<std::pair<int, NodeState*>>& available_ops, const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, bool debug, bool featP, bool featS)
 {
+	PERF_SCOPE(PERF_PRIORITY);
 	
 	// SILVIA'S NEW IMPROVEMENT IDEA
 	if (featS){
-		calculate_second_priority(available_ops, ops, delay);
-		calculate_third_priority(available_ops, ops, delay);
+		TRACE_SCOPE("second_third_priority", "priority");
+		calculate_second_priority(available_ops, graph, delay);
+		calculate_third_priority(available_ops, graph, delay);
 	}
 	// END OF SILVIA'S NEW IMPROVEMENT IDEA
 
-	calculate_first_priority(available_ops, ops, delay, debug, featP, featS);
+	TraceScope first_trace("first_priority", "priority");
+	first_trace.arg("candidates", available_ops.size());
+	calculate_first_priority(available_ops, graph, state, delay, debug, featP, featS);
 	
 }
 
 
 // Get ASAP latency
-int ASAP_latency(std::map<int, G_Node>& ops, std::vector<int>& delay)
+int ASAP_latency(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay)
 {
-	ASAP(ops, delay);
+	state.resize(graph.opn);
+	ASAP(graph, state, delay);
 
 	int LC = 0;
 
-	for (auto const& [id, node] : ops) {
-		int finish_time = node.asap + delay[node.type] - 1;
+	for (int id = 0; id < graph.opn; id++) {
+		int finish_time = state[id].asap + delay[graph.type[id]] - 1;
 
 		if (finish_time > LC) {
 			LC = finish_time;
@@ -740,29 +914,70 @@ int ASAP_latency(std::map<int, G_Node>& ops, std::vector<int>& delay)
 	return LC;
 }
 
+// Per-type parallelism of the ASAP schedule (state[].asap) against the resource constraints.
+// Operations of a type without constraint (type >= res_constr.size()) make every type count as binding.
+void AnalyzeResources(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay, const std::vector<int>& res_constr, ResourceProfile& profile)
+{
+	int numberOfFunctionType = res_constr.size();
+	bool unconstrained_ops = false;
+
+	int latency = 0;
+	for (int id = 0; id < graph.opn; id++)
+		latency = std::max(latency, state[id].asap + delay[graph.type[id]] - 1);
+
+	profile.ops.assign(numberOfFunctionType, 0);
+	profile.asap_peak.assign(numberOfFunctionType, 0);
+	profile.slack.assign(numberOfFunctionType, 0);
+	profile.usage.assign(numberOfFunctionType * (latency + 2), 0);
+
+	for (int id = 0; id < graph.opn; id++) {
+		int t = graph.type[id];
+		if (t >= numberOfFunctionType) {
+			unconstrained_ops = true;
+			continue;
+		}
+		profile.ops[t]++;
+		profile.usage[t * (latency + 2) + state[id].asap]++;
+		profile.usage[t * (latency + 2) + state[id].asap + delay[t]]--;
+	}
+
+	profile.all_slack = !unconstrained_ops;
+	for (int t = 0; t < numberOfFunctionType; t++) {
+		int running = 0;
+		for (int cc = 1; cc <= latency; cc++) {
+			running += profile.usage[t * (latency + 2) + cc];
+			profile.asap_peak[t] = std::max(profile.asap_peak[t], running);
+		}
+
+		profile.slack[t] = (profile.ops[t] <= res_constr[t]);
+		if (profile.asap_peak[t] > res_constr[t])
+			profile.all_slack = false;
+	}
+}
+
 // SILVIA'S NEW IMPROVEMENT IDEA
 
-// Helper to computer stiffness recursively with memoization
-float get_stiffness(int nodeId, std::map<int, G_Node>& ops, std::vector<int>& delay, std::map<int, float>& memo) {
+// Helper to computer stiffness recursively with memoization (memo[id] < 0: not computed yet)
+float get_stiffness(int nodeId, const DFGGraph& graph, std::vector<int>& delay, std::vector<float>& memo) {
 
 	// Check if already computed
-    if (memo.count(nodeId)) {
+    if (memo[nodeId] >= 0.0f) {
         return memo[nodeId];
     }
 
 	// Compute latency of this node squared
-    float latency = (float)delay[ops[nodeId].type];
+    float latency = (float)delay[graph.type[nodeId]];
     float latency_2 = latency * latency;
 
     // If it has no children, the stiffness is just the square of its latency
-    if (ops[nodeId].child.empty()) {
+    if (graph.children(nodeId).empty()) {
         return memo[nodeId] = latency_2;
     }
 
     // Find the maximum among all child paths
     float maxChildStiffness = 0.0f;
-    for (auto child : ops[nodeId].child) {
-        float childStiffness = get_stiffness(child->id, ops, delay, memo);
+    for (int child : graph.children(nodeId)) {
+        float childStiffness = get_stiffness(child, graph, delay, memo);
         if (childStiffness > maxChildStiffness) {
             maxChildStiffness = childStiffness;
         }
@@ -772,30 +987,31 @@ float get_stiffness(int nodeId, std::map<int, G_Node>& ops, std::vector<int>& de
     return memo[nodeId] = latency_2 + maxChildStiffness;
 }
 
-void calculate_second_priority(std::vector<std::pair<int, G_Node>>& available_ops, std::map<int, G_Node>& ops, std::vector<int>& delay)
+void calculate_second_priority(std::vector<std::pair<int, NodeState*>>& available_ops, const DFGGraph& graph, std::vector<int>& delay)
 {
 
-	// Map for memoization
-	std::map<int, float> memo;
+	// Memoization per node, and temporary vector to store stiffness values (reused between calls on this thread)
+	static thread_local std::vector<float> memo;
+	static thread_local std::vector<float> stiffness_values;
 
-	// Temporary vector to store stiffness values
-	std::vector<float> stiffness_values;
+	memo.assign(graph.opn, -1.0f);
+	stiffness_values.clear();
 
 	for (auto& [id, node] : available_ops) {
 
 		// Priority 2: 
 		float maxSuccessorStiffness = 0.0f;
 
-        if (node.child.empty()) {
+        if (graph.children(id).empty()) {
         	
 			// If it has no children, the future stiffness is 0
             maxSuccessorStiffness = 0.0f;
         } else {
 
             // Find the child with the worst stiffness
-            for (auto child : node.child) {
+            for (int child : graph.children(id)) {
 
-                float s = get_stiffness(child->id, ops, delay, memo);
+                float s = get_stiffness(child, graph, delay, memo);
                 if (s > maxSuccessorStiffness) {
                     maxSuccessorStiffness = s;
                 }
@@ -803,8 +1019,7 @@ void calculate_second_priority(std::vector<std::pair<int, G_Node>>& available_op
         }
 
 		// Store negative sum to have higher priority for higher sum values
-		ops[id].priority2 = maxSuccessorStiffness;
-		node.priority2 = maxSuccessorStiffness;
+		node->priority2 = maxSuccessorStiffness;
 
 		stiffness_values.push_back(maxSuccessorStiffness);
 	}
@@ -815,26 +1030,23 @@ void calculate_second_priority(std::vector<std::pair<int, G_Node>>& available_op
 
 	for (auto& [id, node] : available_ops) {
 		if (maxVal == minVal) {
-			node.priority2 = 0.0f;   
-			ops[id].priority2 = 0.0f;
+			node->priority2 = 0.0f;   
 		} else {
-			float normalized = (node.priority2 - minVal) / (maxVal - minVal);
+			float normalized = (node->priority2 - minVal) / (maxVal - minVal);
 			// Lower value = higher stiffness, so invert
-			node.priority2 = 1.0f - normalized;
-			ops[id].priority2 = 1.0f - normalized;
+			node->priority2 = 1.0f - normalized;
 		}
 	}
 
 }
 
-void calculate_third_priority(std::vector<std::pair<int, G_Node>>& available_ops, std::map<int, G_Node>& ops, std::vector<int>& delay)
+void calculate_third_priority(std::vector<std::pair<int, NodeState*>>& available_ops, const DFGGraph& graph, std::vector<int>& delay)
 {
 	for (auto& [id, node] : available_ops) {
 
 		// Priority 3: Number of immediate children (more children -> higher priority)
 		// Store negative number to have higher priority for more children
-		ops[id].priority3 = - ops[id].child.size();
-		node.priority3 = - ops[id].child.size();
+		node->priority3 = - graph.children(id).size();
 	}
 
 }
@@ -854,8 +1066,8 @@ void calculate_third_priority(std::vector<std::pair<int, G_Node>>& available_ops
 // ORIGINAL PRIORITY CALCULATION FUNCTION FROM THE MIDTERM
 // please's idea Probabilistic Priority Weight
 
-void calculate_first_priority(std::vector<std::pair<int, G_Node>>& available_ops,
-                              std::map<int, G_Node>& ops,
+void calculate_first_priority(std::vector<std::pair<int, NodeState*>>& available_ops,
+                              const DFGGraph& graph, std::vector<NodeState>& state,
                               std::vector<int>& delay, bool debug, bool featP, bool featS)
 {
     if (available_ops.empty()) return;
@@ -865,12 +1077,11 @@ void calculate_first_priority(std::vector<std::pair<int, G_Node>>& available_ops
     // Derive a target latency horizon from ALAP values:
     //    L_target = max_u (ALAP(u) + latency(u) - 1)
     int target_latency = 0;
-    for (const auto &kv : ops) {
-        const G_Node &node = kv.second;
-        int func_type = node.type;
+    for (int id = 0; id < graph.opn; id++) {
+        int func_type = graph.type[id];
         if (func_type < 0 || func_type >= numberOfFunctionType) continue;
 
-        int finish_latest = node.alap + delay[func_type] - 1;
+        int finish_latest = state[id].alap + delay[func_type] - 1;
         if (finish_latest > target_latency) {
             target_latency = finish_latest;
         }
@@ -879,12 +1090,13 @@ void calculate_first_priority(std::vector<std::pair<int, G_Node>>& available_ops
 
     // Build FDS graphs q_k(m) using Silvia's function.
     //    fds_graphs[func_type][cycle] = expected usage of that resource in that cycle.
-    std::vector<std::vector<float>> fds_graphs(
-        numberOfFunctionType,
-        std::vector<float>(target_latency + 2, 0.0f)
-    );
+    //    The buffers are reused between calls on this thread.
+    static thread_local std::vector<std::vector<float>> fds_graphs;
+    fds_graphs.resize(numberOfFunctionType);
+    for (auto& graph : fds_graphs)
+        graph.assign(target_latency + 2, 0.0f);
 
-    calculate_fds_graphs(ops, fds_graphs, target_latency, delay, debug);
+    calculate_fds_graphs(graph, state, fds_graphs, target_latency, delay, debug);
 
 	if (debug) {
         std::vector<int> dummy_constr; // Empty constraint just to make it compile
@@ -893,8 +1105,8 @@ void calculate_first_priority(std::vector<std::pair<int, G_Node>>& available_ops
 
     // Helper: compute local congestion C_local(u) from FDS
     auto compute_C_local = [&](int opId) -> float {
-        const G_Node &node = ops.at(opId);
-        int func_type = node.type;
+        const NodeState &node = state[opId];
+        int func_type = graph.type[opId];
 
         // Ignore SOURCE/SINK or invalid types
         if (func_type < 0 || func_type >= numberOfFunctionType) return 0.0f;
@@ -918,22 +1130,30 @@ void calculate_first_priority(std::vector<std::pair<int, G_Node>>& available_ops
         return static_cast<float>(sum_q / count);
     };
 
-    // Compute raw S(u) and C(u) for all available operations
-    std::map<int, double> rawS;
-    std::map<int, double> rawC;
+    // Compute raw S(u) and C(u) for all available operations, rawS[i] / rawC[i] are those of available_ops[i]
+    static thread_local std::vector<double> rawS;
+    static thread_local std::vector<double> rawC;
+    static thread_local std::vector<int> visited;	//visited[id] == visit_stamp: already on the current chain
+    static thread_local int visit_stamp = 0;
+
+    rawS.assign(available_ops.size(), 0.0);
+    rawC.assign(available_ops.size(), 0.0);
+    if (static_cast<int>(visited.size()) < graph.opn)
+        visited.assign(graph.opn, 0);
 
     double s_max = 1e-6;
     double c_max = 1e-6;
 
-    for (auto &entry : available_ops) {
+    for (size_t i = 0; i < available_ops.size(); i++) {
+        auto &entry = available_ops[i];
         int id = entry.first;
-        const G_Node &node = ops.at(id);
+        const NodeState &node = *entry.second;
 
         // Slack term S(u) = (mobility + 1)
         int mobility = node.alap - node.asap; // >= 0 ideally
         if (mobility < 0) mobility = 0;
         double S = static_cast<double>(mobility + 1);
-        rawS[id] = S;
+        rawS[i] = S;
         if (S > s_max) s_max = S;
 
         // Congestion term C(u): average along critical successor chain 
@@ -941,57 +1161,56 @@ void calculate_first_priority(std::vector<std::pair<int, G_Node>>& available_ops
         int len = 0;
 
         int current = id;
-        std::set<int> visited; // avoid accidental loops
+        visit_stamp++; // avoid accidental loops
 
-        while (current != -1 && !visited.count(current)) {
-            visited.insert(current);
+        while (current != -1 && visited[current] != visit_stamp) {
+            visited[current] = visit_stamp;
 
             float C_local = compute_C_local(current);
             sumC += static_cast<double>(C_local);
             ++len;
 
-            int next = ops.at(current).criticalSuccessorId;
+            int next = state[current].criticalSuccessorId;
             if (next == current) break; // safety
             current = next;
         }
 
         double C = (len > 0) ? (sumC / static_cast<double>(len)) : 0.0;
-        rawC[id] = C;
+        rawC[i] = C;
         if (C > c_max) c_max = C;
     }
 
     // Normalize and compute final priority F(u)
-    const double EPS = 1e-4;
-    const double ALPHA = 1.0; // exponent for S_norm
-    const double BETA  = 1.0; // exponent for C_norm
+    // Multi-start passes draw their own weights, with the featP formula
+    const double EPS = ls_perturbation ? ls_perturbation->eps : 1e-4;
+    const double ALPHA = ls_perturbation ? ls_perturbation->alpha : 1.0; // exponent for S_norm
+    const double BETA  = ls_perturbation ? ls_perturbation->beta : 1.0; // exponent for C_norm
+    bool weighted = featP || ls_perturbation != nullptr;
 
-    for (auto &entry : available_ops) {
-        int id = entry.first;
+    for (size_t i = 0; i < available_ops.size(); i++) {
+        auto &entry = available_ops[i];
 
-        double s_norm = rawS[id] / s_max;
-        double c_norm = (c_max > 0.0) ? (rawC[id] / c_max) : 0.0;
+        double s_norm = rawS[i] / s_max;
+        double c_norm = (c_max > 0.0) ? (rawC[i] / c_max) : 0.0;
 
         // Probabilistic weighting:
         // F(u) = S_norm^ALPHA * (C_norm + EPS)^BETA
 		double F = 0.0;
 
-		if (featP && featS) {
-        	F = std::pow(s_norm, ALPHA) * std::pow(c_norm + EPS, BETA) * entry.second.priority2;
+		if (weighted && featS) {
+        	F = std::pow(s_norm, ALPHA) * std::pow(c_norm + EPS, BETA) * entry.second->priority2;
 		}
-		else if (!featP && featS) {
-			F = s_norm * (c_norm + EPS) * entry.second.priority2;
-		} else if (featP && !featS) {
+		else if (!weighted && featS) {
+			F = s_norm * (c_norm + EPS) * entry.second->priority2;
+		} else if (weighted && !featS) {
 			F = std::pow(s_norm, ALPHA) * std::pow(c_norm + EPS, BETA);
 		} else {
 			F = s_norm * (c_norm + EPS);
 		}
 
-        // Write into the global ops map 
-        ops[id].priority1 = F;
-
-        // also update the local copy stored in available_ops
-        // so that PrioritySorting, which compares pair.second, sees it.
-        entry.second.priority1 = F;
+        // Write into the state array: available_ops points to its entries,
+        // so PrioritySorting, which compares pair.second, sees it.
+        entry.second->priority1 = F;
     }
 
 
@@ -1000,19 +1219,19 @@ void calculate_first_priority(std::vector<std::pair<int, G_Node>>& available_ops
 		cout << "\n[DEBUG PRIORITY 1 DETAILS]" << endl;
 		cout << "ID\tS_raw\tS_norm\tC_raw\tC_norm\tFinal_F" << endl;
 
-		for (auto &entry : available_ops) {
-			int id = entry.first;
+		for (size_t i = 0; i < available_ops.size(); i++) {
+			int id = available_ops[i].first;
 
-			double s_norm = rawS[id] / s_max;
-			double c_norm = (c_max > 0.0) ? (rawC[id] / c_max) : 0.0;
+			double s_norm = rawS[i] / s_max;
+			double c_norm = (c_max > 0.0) ? (rawC[i] / c_max) : 0.0;
 
-			double F = ops[id].priority1;
+			double F = state[id].priority1;
 
 			// Debug print
 			cout << id << "\t" 
-				<< rawS[id] << "\t" 
+				<< rawS[i] << "\t" 
 				<< fixed << setprecision(2) << s_norm << "\t" 
-				<< rawC[id] << "\t" 
+				<< rawC[i] << "\t" 
 				<< c_norm << "\t" 
 				<< F << endl;
 		}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
 // #include <tchar.h> on Windows
 #include <cstdlib>
 #include <iostream>
@@ -18,6 +19,7 @@
 #include <cmath>
 #include <iomanip>
 #include <cstring>
+#include <random>
 
 #define MAX_ITERATIONS 100
 
@@ -25,21 +27,52 @@
 
 using namespace std;
 
-struct G_Node    //save the info for operation node
+struct G_Node    //save the info for operation node, as read from the DFG file
 {
 	int id; //node ID
 	int type; //node Function-type
 	list<G_Node*> child;   // successor nodes (distance = 1)
 	list<G_Node*> parent;  // predecessor nodes (distance = 1)
-	int asap, alap;
-	bool schl;
+};
+
+// Read-only DFG the schedulers work on, built once per DFG with BuildGraph(). Nothing writes to it while
+// scheduling, so one instance can be shared by any number of threads; what a run computes goes to a NodeState array.
+// Successors and predecessors are kept in compressed (CSR) arrays, in the order of the G_Node lists.
+struct DFGGraph
+{
+	struct IdRange		// IDs of the successors or the predecessors of one operation
+	{
+		const int* first;
+		const int* last;
+
+		const int* begin() const { return first; }
+		const int* end() const { return last; }
+		int size() const { return static_cast<int>(last - first); }
+		bool empty() const { return first == last; }
+	};
+
+	int opn = 0;						// # of operations
+	vector<int> type;					// Function type of each operation
+	vector<int> child_start, child;		// successors of op i: child[child_start[i]] .. child[child_start[i + 1] - 1]
+	vector<int> parent_start, parent;	// predecessors, same layout
+
+	IdRange children(int op) const { return { child.data() + child_start[op], child.data() + child_start[op + 1] }; }
+	IdRange parents(int op) const { return { parent.data() + parent_start[op], parent.data() + parent_start[op + 1] }; }
+};
+
+struct NodeState    //values a scheduling run computes for an operation: one array per run, indexed by node ID
+{
+	int asap = -1, alap = -1;
+	bool schl = false;
 
 	// IMPLEMENTED BY SILVIA
-	int criticalSuccessorId; // ID of the critical successor node
-	float priority1; // priority value for FDS-based scheduling
-	float priority2; // second priority value for FDS-based scheduling
-	int priority3; // third priority value for FDS-based scheduling
+	int criticalSuccessorId = -1; // ID of the critical successor node
+	float priority1 = 0.0f; // priority value for FDS-based scheduling
+	float priority2 = 0.0f; // second priority value for FDS-based scheduling
+	int priority3 = 0; // third priority value for FDS-based scheduling
 	// END IMPLEMENTED BY SILVIA
+
+	unsigned tie = 0;	// random tie-break of the ready list orders (--multistart), 0 in the deterministic LS
 };
 
 
@@ -53,6 +86,32 @@ struct ConstraintData {
 
 // END IMPLEMENTED BY SILVIA
 
+// Summary of a streaming LS run (StreamLS.cpp)
+struct StreamStats {
+	int opn = 0;				// # of operations read
+	int edges = 0;				// # of edges read
+	int latency = 0;			// actual latency
+	std::vector<int> fus_used;	// # of FUs used per Function type
+	int peak_resident = 0;		// max # of nodes held in memory at once
+};
+
+// Cancellation of the scheduling runs of a thread (portfolio mode): once the flag it points to is set, LS_outer_loop,
+// FDS_Outer_Loop and FDS stop at their next pass, leaving an unfinished result. nullptr (default): never cancelled.
+extern thread_local const std::atomic<bool>* schedule_cancel;
+inline bool schedule_cancelled() { return schedule_cancel != nullptr && schedule_cancel->load(std::memory_order_relaxed); }
+
+// Randomized LS of a thread (multi-start mode): the ops of a ready list that the priority orders leave tied get a
+// random order, and the first priority uses these exponents and epsilon instead of 1, 1 and 1e-4 (as with featP).
+// nullptr (default): the deterministic LS.
+struct LSPerturbation
+{
+	std::mt19937 rng;
+	double alpha = 1.0;		// exponent of the normalized slack
+	double beta = 1.0;		// exponent of the normalized congestion
+	double eps = 1e-4;		// added to the normalized congestion
+};
+extern thread_local LSPerturbation* ls_perturbation;
+
 void READ_LIB(const string& file_name,
 	vector<int>& delay,
 	vector<int>& lp,
@@ -63,6 +122,9 @@ void READ_LIB(const string& file_name,
 
 void Read_DFG(int& DFG, string& filename, string& dfg_name, string suffix); //Read-DFG filename
 void readGraphInfo(string& filename, int& edge_num, int& opn, std::map<int, G_Node>& ops);
+void LoadConstraints(const string& filename, std::map<string, ConstraintData>& db); //"<name> <target latency> <rc of each type>" lines
+bool readGraphInfoBinary(string& filename, int& edge_num, int& opn, std::map<int, G_Node>& ops); //DFG generated with --binary (.dfgb)
+void BuildGraph(const std::map<int, G_Node>& ops, DFGGraph& graph); //read-only copy of ops for the schedulers
 
 
 
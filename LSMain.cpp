@@ -7,6 +7,9 @@
 #else
     #include <sys/stat.h> // macOS/Linux-specific header
     #include <sys/types.h>
+    #ifdef __linux__
+        #include <sched.h>  // sched_setaffinity for --pin
+    #endif
     #define MAKE_DIR(name) mkdir(name, 0777)
 #endif
 
@@ -15,6 +18,18 @@
 #include <sstream>
 #include <iomanip>
 
+#include "Verify.h"
+#include "Instrument.h"
+#include "Trace.h"
+#include "Perf.h"
+#include "Stats.h"
+#include "AllocCount.h"
+#include "ScheduleCache.h"
+#include "Portfolio.h"
+#include "LowerBound.h"
+#include "BranchBound.h"
+#include "MultiStart.h"
+
 // END IMPLEMENTED BY SILVIA
 
 
@@ -28,21 +43,34 @@ int edge_num = 0;
 //G_Node* ops; //operations list
 
 void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
-	std::map<int, G_Node>& ops, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool featS, bool featP);
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool featS, bool featP);
 void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
-	std::map<int, G_Node>& ops, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP);
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP);
 
 
-void FDS_Outer_Loop(std::map<int, G_Node>& ops, std::vector<int>& delay, int& LC, double& latencyParameter, std::vector<int>& res_constr, bool debug);
+bool FDS_Outer_Loop(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC, double& latencyParameter, std::vector<int>& res_constr, bool debug, int threads, int lookahead, bool bisect, int probes, int& fds_runs);
+void FDS_Binding(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay,
+	std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult,
+	int& actualLatency);
 
 // IMPLEMENTED BY SILVIA
 
-void WriteResultToCSV(string algName, string dfgName, string data_type, bool featS, bool featP, int targetLat, int actualLat, int totalFUs, double runtimeMs, double res_scaling_factor, bool ls_base);
-void LoadConstraints(const string& filename, std::map<string, ConstraintData>& db);  
+void WriteResultToCSV(string algName, string dfgName, string data_type, bool featS, bool featP, int targetLat, int actualLat, int totalFUs, double runtimeMs, double res_scaling_factor, bool ls_base,
+	const std::vector<std::pair<string, string>>& extra_columns = {});
 std::string to_string_with_precision(float value, int n_decimals); 
+bool VerifyResult(std::map<int, G_Node>& ops, int opn, std::map<int, int>& schlResult, std::map<int, int>& opBindingResult, std::map<int, int>& FUAllocationResult,
+	int actualLatency, std::vector<int>& delay, std::vector<int>& res_constr, std::vector<string>& res_type, string DFGname, bool debug);
 
 // END IMPLEMENTED BY SILVIA
 
+int BindOperations(std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, std::map<int, int>& opBindingResult);
+
+bool StreamLS(const string& dfg_file, const string& dfg_name, const string& result_file, std::vector<int>& delay,
+	std::vector<int>& res_constr, std::vector<string>& res_type, int window, StreamStats& stats, bool debug);
+int RunStreamLS(const string& dfg_file, int window, std::map<string, ConstraintData>& constraints_db, std::vector<int>& delay,
+	std::vector<string>& res_type, string data_type, double res_scaling_factor, bool debug);
+bool PinToCurrentCPU();
+
 ofstream output_sb_result;
 
 int main(int argc, char** argv)
@@ -75,6 +103,181 @@ int main(int argc, char** argv)
 		res_scaling_factor = std::stod(argv[6]);
     }
 
+	// Optional flags after the positional arguments
+	bool verify = false;		// validate every produced schedule in memory (same checks as the checker)
+	string stream_file;			// schedule this DFG file with the streaming LS instead of the DFG 0..22 loop
+	int stream_window = 4096;	// max # of nodes the streaming LS keeps in memory
+	string dfg_file;			// schedule this DFG file (text or .dfgb) instead of the DFG 0..22 loop
+	string trace_file;			// write a Chrome trace-event timeline of the run to this file
+	string perf_file;			// write hardware counters per DFG and phase to this file (CSV)
+	int repeat_runs = 1;		// timed scheduling runs per DFG
+	int warmup_runs = 0;		// untimed scheduling runs per DFG before the timed ones
+	bool measure_runtime = false;	// --repeat/--warmup given: report runtime statistics
+	bool pin = false;			// pin the scheduler to the CPU it starts on
+	string cache_dir;			// reuse the results of identical (graph, constraints, configuration) runs stored in this directory
+	bool cache_verify = false;	// verify every cache hit, an entry failing the checks is scheduled again
+	bool fds = false;			// --engine=fds: force-directed scheduling (FDS_Outer_Loop) instead of LS
+	bool fds_bisect = true;		// FDS: bisection over the LC, or the +3 steps (--fds-search=step)
+	int fds_threads = 1;		// FDS: threads evaluating the candidates of an iteration (0 = one per core)
+	int fds_lookahead = 1;		// FDS: depth of the predecessors / successors in the forces
+	int fds_probes = 1;			// FDS: LCs evaluated in parallel per bisection round
+	bool bb = false;			// --engine=bb: branch and bound from the LS schedule
+	int bb_time_ms = 10000;		// BB: time budget of the search per DFG (0 = none)
+	int bb_threads = 0;			// BB: threads sharing the search (0 = one per core)
+	int multistart = 0;			// --multistart=N: N randomized LS passes, the best schedule is kept (0 = off)
+	unsigned multistart_seed = 1;	// seed of the first randomized pass, the next ones follow
+	int multistart_threads = 0;	// threads running the passes (0 = one per core)
+	bool portfolio = false;		// --portfolio: run several engines concurrently and keep the best schedule
+	string portfolio_list;		// members of the portfolio, empty = the default ones
+
+	for (int i = (argc >= 7 ? 7 : 1); i < argc; i++) {
+		string arg = argv[i];
+
+		if (arg == "--verify")
+			verify = true;
+		else if (arg.rfind("--stream=", 0) == 0)
+			stream_file = arg.substr(9);
+		else if (arg.rfind("--window=", 0) == 0)
+			stream_window = std::stoi(arg.substr(9));
+		else if (arg.rfind("--dfg=", 0) == 0)
+			dfg_file = arg.substr(6);
+		else if (arg.rfind("--trace=", 0) == 0)
+			trace_file = arg.substr(8);
+		else if (arg.rfind("--perf=", 0) == 0)
+			perf_file = arg.substr(7);
+		else if (arg.rfind("--repeat=", 0) == 0) {
+			repeat_runs = std::max(1, std::stoi(arg.substr(9)));
+			measure_runtime = true;
+		}
+		else if (arg.rfind("--warmup=", 0) == 0) {
+			warmup_runs = std::max(0, std::stoi(arg.substr(9)));
+			measure_runtime = true;
+		}
+		else if (arg == "--pin")
+			pin = true;
+		else if (arg == "--cache")
+			cache_dir = "Cache";
+		else if (arg.rfind("--cache=", 0) == 0)
+			cache_dir = arg.substr(8);
+		else if (arg == "--cache-verify")
+			cache_verify = true;
+		else if (arg.rfind("--engine=", 0) == 0) {
+			// ls = base LS (same as the positional ls_base = 1), fdls = LS_outer_loop, fds = FDS, bb = branch and bound
+			string engine = arg.substr(9);
+			if (engine == "ls")
+				ls_base = true;
+			else if (engine == "fdls")
+				ls_base = false;
+			else if (engine == "fds")
+				fds = true;
+			else if (engine == "bb")
+				bb = true;
+			else {
+				cerr << "Error: unknown engine " << engine << " (ls, fdls, fds or bb)." << endl;
+				return 1;
+			}
+		}
+		else if (arg.rfind("--fds-search=", 0) == 0)
+			fds_bisect = arg.substr(13) != "step";
+		else if (arg.rfind("--fds-threads=", 0) == 0)
+			fds_threads = std::stoi(arg.substr(14));
+		else if (arg.rfind("--fds-lookahead=", 0) == 0)
+			fds_lookahead = std::max(0, std::stoi(arg.substr(16)));
+		else if (arg.rfind("--fds-probes=", 0) == 0)
+			fds_probes = std::max(1, std::stoi(arg.substr(13)));
+		else if (arg.rfind("--bb-time=", 0) == 0)
+			bb_time_ms = std::max(0, std::stoi(arg.substr(10)));
+		else if (arg.rfind("--bb-threads=", 0) == 0)
+			bb_threads = std::stoi(arg.substr(13));
+		else if (arg.rfind("--multistart=", 0) == 0)
+			multistart = std::max(1, std::stoi(arg.substr(13)));
+		else if (arg.rfind("--multistart-seed=", 0) == 0)
+			multistart_seed = static_cast<unsigned>(std::stoul(arg.substr(18)));
+		else if (arg.rfind("--multistart-threads=", 0) == 0)
+			multistart_threads = std::stoi(arg.substr(21));
+		else if (arg == "--portfolio")
+			portfolio = true;
+		else if (arg.rfind("--portfolio=", 0) == 0) {
+			portfolio = true;
+			portfolio_list = arg.substr(12);
+		}
+		else
+			cerr << "Warning: unknown option " << arg << " ignored." << endl;
+	}
+
+	int verify_failures = 0;
+
+	// FDS results go to Results_FDS_<DFG>_S0_P0 and CSV Results_FDS_<type>_S0_P0, as the earlier FDS experiments
+	string engine_options;
+	if (fds) {
+		if (featS || featP || ls_base)
+			cerr << "Warning: featS, featP and the base LS mode do not apply to --engine=fds, ignored." << endl;
+		algName = "FDS";
+		featS = featP = ls_base = false;
+
+		stringstream options;
+		options << "FDS search=" << (fds_bisect ? "bisect" : "step") << " probes=" << (fds_bisect ? fds_probes : 1) << " lookahead=" << fds_lookahead;
+		engine_options = options.str();
+	}
+
+	// BB results go to Results_BB_<DFG>[_S<x>_P<y>], the LS schedule it starts from is the one of the flags
+	if (bb) {
+		if (fds) {
+			cerr << "Error: --engine=fds and --engine=bb are exclusive." << endl;
+			return 1;
+		}
+		algName = "BB";
+
+		stringstream options;
+		options << "BB time=" << bb_time_ms << " threads=" << bb_threads;
+		engine_options = options.str();
+	}
+
+	// Multi-start results go to Results_MultiStart_<DFG>[_S<x>_P<y>], the passes run the LS of the flags
+	if (multistart > 0) {
+		if (fds || bb) {
+			cerr << "Error: --multistart runs LS passes, it does not apply to --engine=fds or --engine=bb." << endl;
+			return 1;
+		}
+		algName = "MultiStart";
+
+		stringstream options;
+		options << "MultiStart passes=" << multistart << " seed=" << multistart_seed;
+		engine_options = options.str();
+	}
+
+	// Portfolio results go to Results_Portfolio_<DFG> and CSV Results_Portfolio_<type>, named like the base LS ones
+	std::vector<PortfolioMember> portfolio_members;
+	if (portfolio) {
+		if (!parse_portfolio(portfolio_list, portfolio_members))
+			return 1;
+		if (fds || bb || multistart > 0 || featS || featP)
+			cerr << "Warning: --engine, --multistart, featS and featP do not apply to --portfolio, ignored." << endl;
+		algName = "Portfolio";
+		fds = bb = featS = featP = false;
+		multistart = 0;
+		ls_base = true;
+
+		stringstream options;
+		options << "Portfolio members=";
+		for (size_t k = 0; k < portfolio_members.size(); k++)
+			options << (k ? "," : "") << portfolio_members[k].name;
+		options << " FDS search=" << (fds_bisect ? "bisect" : "step") << " probes=" << (fds_bisect ? fds_probes : 1) << " lookahead=" << fds_lookahead;
+		engine_options = options.str();
+	}
+
+	if (!trace_file.empty())
+		trace_start();
+
+	if (!perf_file.empty() && !perf_open(perf_file))
+		return 1;
+
+	if (pin)
+		PinToCurrentCPU();
+
+	if (!cache_dir.empty() && !cache_open(cache_dir))
+		return 1;
+
 	std::vector<int> res_constr;
 	std::vector<string> res_type;
 
@@ -87,6 +290,14 @@ int main(int argc, char** argv)
 
 	LoadConstraints(constraints_filename, constraints_db);
 
+	if (!stream_file.empty()) {
+		if (fds || bb || multistart > 0 || portfolio)
+			cerr << "Warning: --stream schedules with LS, --engine, --multistart and --portfolio ignored." << endl;
+		int status = RunStreamLS(stream_file, stream_window, constraints_db, delay, res_type, data_type, res_scaling_factor, debug);
+		if (!trace_file.empty())
+			trace_write(trace_file);
+		return status;
+	}
 
 
 
@@ -101,16 +312,47 @@ int main(int argc, char** argv)
 			std::cout << "Function ID: " << i << ", Delay: " << delay[i] << ", LP: " << lp[i] << ", DP: " << dp[i] << ", ResType: " << res_type[i] << std::endl;
 	}
 
-	//iterate all DFGs from 0 to 22 (the 16-22 are random DFGs)
-	for (DFG = 0; DFG <= 22; DFG++) {
+	//iterate all DFGs from 0 to 22 (the 16-22 are random DFGs), or only the one given with --dfg
+	int last_DFG = dfg_file.empty() ? 22 : 0;
+
+	for (DFG = 0; DFG <= last_DFG; DFG++) {
+
+		// allocations and peak memory of this DFG: graph, scheduling runs (none unless built with -DLS_ALLOC_COUNT)
+		alloc_reset();
 
 		std::map<int, G_Node> ops;
 		LC = 0, opn = 0, edge_num = 0;
 		ops.clear();
 
 		string filename, dfg_name, clean_dfg_name;
-		Read_DFG(DFG, filename, dfg_name, data_type);			//read DFG filename
-		readGraphInfo(filename, edge_num, opn, ops); //read DFG info
+
+		TraceScope dfg_trace("DFG", "dfg");
+		TraceScope load_trace("load_dfg", "io");
+
+		if (dfg_file.empty()) {
+			Read_DFG(DFG, filename, dfg_name, data_type);			//read DFG filename
+			readGraphInfo(filename, edge_num, opn, ops); //read DFG info
+		} else {
+			// dfg_name is "<name>.txt" as for the benchmarks, whatever the extension of the file
+			filename = dfg_file;
+			dfg_name = dfg_file.substr(dfg_file.find_last_of("/\\") + 1);
+			string extension = dfg_name.find('.') != string::npos ? dfg_name.substr(dfg_name.find('.')) : "";
+			dfg_name = dfg_name.substr(0, dfg_name.find('.')) + ".txt";
+
+			if (extension == ".dfgb") {
+				if (!readGraphInfoBinary(filename, edge_num, opn, ops))
+					return 1;
+			} else
+				readGraphInfo(filename, edge_num, opn, ops);
+		}
+
+		// read-only form of the DFG the schedulers work on
+		DFGGraph graph;
+		BuildGraph(ops, graph);
+
+		load_trace.arg("ops", opn);
+		load_trace.end();
+		dfg_trace.arg("dfg", dfg_name);
 
 
 		// IMPLEMENTED BY SILVIA
@@ -128,12 +370,14 @@ int main(int argc, char** argv)
 		res_constr = constraints_db[clean_dfg_name].resources;
 
 		// Scale the resource constraints
+		TraceScope scale_trace("scale_constraints", "dfg");
 		for (auto& rc : res_constr) {
 			rc = static_cast<int>(rc * res_scaling_factor);
 
 			// Ensure at least 1 resource
 			if (rc < 1) rc = 1;
 		}
+		scale_trace.end();
 
 		if (debug) {
 			cout << "Resource Constraints for DFG " << DFG << " (" << clean_dfg_name << "): " << endl;
@@ -151,6 +395,25 @@ int main(int argc, char** argv)
 
 		// END IMPLEMENTED BY SILVIA
 
+		// the schedulers index the delays and the constraints by op type
+		int known_types = static_cast<int>(std::min(delay.size(), res_constr.size()));
+		int unknown_op = -1;
+		for (int op = 0; op < opn && unknown_op < 0; op++)
+			if (graph.type[op] < 0 || graph.type[op] >= known_types)
+				unknown_op = op;
+		if (unknown_op >= 0) {
+			cerr << "Error: op " << unknown_op << " of DFG " << clean_dfg_name << " has the type " << graph.type[unknown_op]
+				<< ", which has no delay or resource constraint. Skipping this DFG." << endl;
+			continue;
+		}
+
+		// no schedule meeting the constraints is shorter: reported with the gap of the schedule to it
+		LatencyBound latency_bound = latency_lower_bound(graph, delay, res_constr);
+
+		if (debug)
+			cout << "Latency lower bound: " << latency_bound.latency << " (critical path " << latency_bound.critical_path << ", work " << latency_bound.work
+				<< ", combined " << latency_bound.combined << ")" << endl;
+
 
 		std::map<int, int> ops_schl_cc, ops_schl_FU, FU_type;
 		ops_schl_cc.clear();
@@ -183,62 +446,263 @@ int main(int argc, char** argv)
 
 		// CHANGED BY SILVIA
 
-		// Start the timer
-		auto start_time = std::chrono::high_resolution_clock::now();
+		// Untimed warmup runs, then the timed ones; the schedule of the last run is the one written out
+		std::vector<double> runtime_samples;
+		std::map<int, int> first_schlResult;
+		std::map<int, std::map<int, std::vector<int>>> first_bindingResult;
+		int first_latency = 0;
+		bool schedule_stable = true;
+		double runtime_ms = 0;
+		int fds_lc = 0, fds_runs = 0;
+		bool fds_feasible = false;
+		std::vector<PortfolioRun> portfolio_runs;
+		int portfolio_winner = -1, portfolio_bound = 0;
+		BBStats bb_stats;
+		MultiStartStats multistart_stats;
+
+		// --cache: the result of an identical run is reused as is, its runtime is the one of the run that produced it
+		string cache_key;
+		bool cache_hit = false;
+
+		if (!cache_dir.empty()) {
+			cache_key = schedule_cache_key(graph, delay, res_constr, featS, featP, ls_base, latencyParameter, engine_options);
+
+			CachedSchedule entry;
+			if (cache_lookup(cache_key, entry)) {
+				cache_hit = true;
+
+				if (cache_verify) {
+					std::map<int, int> used_FUs = entry.FUAllocationResult, opBinding;
+					BindOperations(used_FUs, entry.bindingResult, opBinding);
+					std::map<int, int> schedule = entry.schlResult;
+
+					cout << "[CACHE] " << clean_dfg_name << ": checking entry " << cache_key << endl;
+					if (!VerifyResult(ops, opn, schedule, opBinding, used_FUs, entry.actualLatency, delay, res_constr, res_type, clean_dfg_name, debug)) {
+						cerr << "Warning: cache entry " << cache_key << " failed verification, scheduling " << clean_dfg_name << " again." << endl;
+						cache_discard(cache_key);
+						cache_hit = false;
+					}
+				}
+			}
 
-		if (ls_base) {
-			
-			// STANDARD LS IMPLEMENTATION
-			LS(schlResult, FUAllocationResult, bindingResult, actualLatency,
-			ops, latencyConstraint, latencyParameter, delay, res_constr, false, debug, false, false);
-		} else {
-			
-			// OUR IMPLEMENTATION
-			LS_outer_loop(schlResult, FUAllocationResult, bindingResult, actualLatency,
-			ops, latencyConstraint, latencyParameter, delay, res_constr, debug, featS, featP);
+			if (cache_hit) {
+				schlResult.swap(entry.schlResult);
+				FUAllocationResult.swap(entry.FUAllocationResult);
+				bindingResult.swap(entry.bindingResult);
+				actualLatency = entry.actualLatency;
+				runtime_ms = entry.runtime_ms;
+				runtime_samples.push_back(runtime_ms);
+				instrument_reset();		//nothing scheduled: the per-phase counters are 0
+			}
 		}
 
-		// Stop the timer
-		auto end_time = std::chrono::high_resolution_clock::now();
+		for (int run = 0; run < (cache_hit ? 0 : warmup_runs + repeat_runs); run++) {
+
+			schlResult.clear();
+			FUAllocationResult.clear();
+			bindingResult.clear();
+			actualLatency = 0;
+			latencyConstraint = 0;
+
+			instrument_reset();
+
+			// Start the timer
+			auto start_time = std::chrono::high_resolution_clock::now();
+
+			if (portfolio) {
+
+				// PORTFOLIO: every member schedules the DFG in its own thread, the best schedule is kept
+				portfolio_winner = RunPortfolio(graph, delay, res_constr, latencyParameter, portfolio_members,
+					fds_lookahead, fds_bisect, fds_probes, debug, portfolio_runs, portfolio_bound);
+				if (portfolio_winner >= 0) {
+					PortfolioRun& best = portfolio_runs[portfolio_winner];
+					schlResult.swap(best.schlResult);
+					FUAllocationResult.swap(best.FUAllocationResult);
+					bindingResult.swap(best.bindingResult);
+					actualLatency = best.actualLatency;
+				} else
+					cerr << "Error: no member of the portfolio produced a schedule for " << clean_dfg_name << "." << endl;
+			} else if (fds) {
+
+				// FDS: schedule at the LC found by the search, then bind it to FUs
+				std::vector<NodeState> fds_state;
+				fds_lc = 0;
+				fds_feasible = FDS_Outer_Loop(graph, fds_state, delay, fds_lc, latencyParameter, res_constr, debug,
+					fds_threads, fds_lookahead, fds_bisect, fds_probes, fds_runs);
+				FDS_Binding(graph, fds_state, delay, schlResult, FUAllocationResult, bindingResult, actualLatency);
+			} else if (bb) {
+
+				// BRANCH AND BOUND: from the LS schedule, within the time budget
+				BB_Schedule(schlResult, FUAllocationResult, bindingResult, actualLatency,
+					graph, latencyParameter, delay, res_constr, debug, ls_base, featS, featP, bb_threads, bb_time_ms, bb_stats);
+			} else if (multistart > 0) {
+
+				// MULTI-START: randomized LS passes in parallel, the best schedule is kept
+				MultiStart_Schedule(schlResult, FUAllocationResult, bindingResult, actualLatency,
+					graph, latencyParameter, delay, res_constr, debug, ls_base, featS, featP, multistart, multistart_seed, multistart_threads, multistart_stats);
+			} else if (ls_base) {
+				
+				// STANDARD LS IMPLEMENTATION
+				LS(schlResult, FUAllocationResult, bindingResult, actualLatency,
+				graph, latencyConstraint, latencyParameter, delay, res_constr, false, debug, false, false);
+			} else {
+				
+				// OUR IMPLEMENTATION
+				LS_outer_loop(schlResult, FUAllocationResult, bindingResult, actualLatency,
+				graph, latencyConstraint, latencyParameter, delay, res_constr, debug, featS, featP);
+			}
 
-		
-        std::chrono::duration<double, std::milli> duration = end_time - start_time;
-        double runtime_ms = duration.count();
+			// Stop the timer
+			auto end_time = std::chrono::high_resolution_clock::now();
+
+			
+	        std::chrono::duration<double, std::milli> duration = end_time - start_time;
+	        runtime_ms = duration.count();
+
+			if (run < warmup_runs)
+				continue;
+
+			runtime_samples.push_back(runtime_ms);
+
+			// every timed run must give the same schedule and binding
+			if (runtime_samples.size() == 1) {
+				first_schlResult = schlResult;
+				first_bindingResult = bindingResult;
+				first_latency = actualLatency;
+			} else if (schlResult != first_schlResult || bindingResult != first_bindingResult || actualLatency != first_latency)
+				schedule_stable = false;
+		}
+
+		// per-phase counters of this DFG, from the last run (none unless built with -DLS_INSTRUMENT)
+		std::vector<std::pair<string, string>> instrument_cols = instrument_columns();
+
+		std::vector<std::pair<string, string>> alloc_cols = alloc_columns();
+		instrument_cols.insert(instrument_cols.end(), alloc_cols.begin(), alloc_cols.end());
+
+		// --repeat / --warmup: Runtime_ms is the median, the spread goes in extra columns
+		if (measure_runtime) {
+			SampleStats runtime_stats = summarize(runtime_samples);
+			runtime_ms = runtime_stats.median;
+
+			std::vector<std::pair<string, string>> measure_cols;
+			measure_cols.push_back(std::make_pair("Repeats", to_string(runtime_stats.count)));
+			measure_cols.push_back(std::make_pair("Runtime_min_ms", to_string(runtime_stats.min)));
+			measure_cols.push_back(std::make_pair("Runtime_median_ms", to_string(runtime_stats.median)));
+			measure_cols.push_back(std::make_pair("Runtime_p95_ms", to_string(runtime_stats.p95)));
+			measure_cols.push_back(std::make_pair("Runtime_stddev_ms", to_string(runtime_stats.stddev)));
+			measure_cols.push_back(std::make_pair("Schedule_Stable", schedule_stable ? "YES" : "NO"));
+			instrument_cols.insert(instrument_cols.begin(), measure_cols.begin(), measure_cols.end());
+
+			std::cout << "Runtime over " << runtime_stats.count << " runs (" << warmup_runs << " warmup): min " << runtime_stats.min
+				<< " ms, median " << runtime_stats.median << " ms, p95 " << runtime_stats.p95 << " ms, stddev " << runtime_stats.stddev
+				<< " ms, schedule " << (schedule_stable ? "identical" : "NOT identical") << " across runs" << endl;
+		}
 
 		// END CHANGED BY SILVIA
 
-		for (auto type = 0; type < FUAllocationResult.size(); type++){
-			int reallyUsedFUs = 0;
-			int numOfFUs = FUAllocationResult[type];
-			
-			for (auto fu = 0; fu < numOfFUs; fu++) {
-				if (bindingResult.count(type) && 
-					bindingResult[type].count(fu) && 
-					!bindingResult[type][fu].empty()) {
-					reallyUsedFUs++;
-				}
+		// FDS: LC of the schedule, whether it meets the constraints, # of FDS runs of the search (not known on a cache hit)
+		if (fds) {
+			std::vector<std::pair<string, string>> fds_cols;
+			fds_cols.push_back(std::make_pair("FDS_LC", cache_hit ? "" : to_string(fds_lc)));
+			fds_cols.push_back(std::make_pair("FDS_Feasible", cache_hit ? "" : (fds_feasible ? "YES" : "NO")));
+			fds_cols.push_back(std::make_pair("FDS_Runs", cache_hit ? "" : to_string(fds_runs)));
+			instrument_cols.insert(instrument_cols.begin(), fds_cols.begin(), fds_cols.end());
+
+			if (!cache_hit)
+				std::cout << "[FDS] " << clean_dfg_name << ": LC " << fds_lc << (fds_feasible ? "" : " (no feasible LC found)") << " after " << fds_runs << " FDS runs" << endl;
+		}
+
+		// BB: latency of the LS schedule, proven bound and gap (not known on a cache hit)
+		if (bb) {
+			std::vector<std::pair<string, string>> bb_cols;
+			bb_cols.push_back(std::make_pair("BB_Initial_Latency", cache_hit ? "" : to_string(bb_stats.initial_latency)));
+			bb_cols.push_back(std::make_pair("BB_Proven_Bound", cache_hit ? "" : to_string(bb_stats.lower_bound)));
+			bb_cols.push_back(std::make_pair("BB_Proven_Gap", cache_hit || bb_stats.lower_bound <= 0 ? ""
+				: to_string_with_precision(static_cast<double>(actualLatency - bb_stats.lower_bound) / bb_stats.lower_bound, 4)));
+			bb_cols.push_back(std::make_pair("BB_Optimal", cache_hit ? "" : (bb_stats.optimal ? "YES" : "NO")));
+			bb_cols.push_back(std::make_pair("BB_Nodes", cache_hit ? "" : to_string(bb_stats.nodes)));
+			instrument_cols.insert(instrument_cols.begin(), bb_cols.begin(), bb_cols.end());
+
+			if (!cache_hit)
+				std::cout << "[BB] " << clean_dfg_name << ": latency " << actualLatency << " (LS " << bb_stats.initial_latency << "), proven bound " << bb_stats.lower_bound
+					<< (bb_stats.optimal ? ", optimal" : (bb_stats.timed_out ? ", time budget reached" : "")) << ", " << bb_stats.nodes << " nodes, "
+					<< bb_stats.finished << "/" << bb_stats.subproblems << " subproblems searched in " << bb_stats.search_ms << " ms" << endl;
+		}
+
+		// Multi-start: the pass kept and its seed, against the deterministic LS (not known on a cache hit)
+		if (multistart > 0) {
+			std::vector<std::pair<string, string>> multistart_cols;
+			multistart_cols.push_back(std::make_pair("MultiStart_Passes", cache_hit ? "" : to_string(multistart_stats.passes)));
+			multistart_cols.push_back(std::make_pair("MultiStart_Best_Pass", cache_hit ? "" : to_string(multistart_stats.best_pass)));
+			multistart_cols.push_back(std::make_pair("MultiStart_Seed", cache_hit || multistart_stats.best_pass == 0 ? "" : to_string(multistart_stats.seed)));
+			multistart_cols.push_back(std::make_pair("MultiStart_Deterministic_Latency", cache_hit ? "" : to_string(multistart_stats.deterministic_latency)));
+			multistart_cols.push_back(std::make_pair("MultiStart_Improved_Passes", cache_hit ? "" : to_string(multistart_stats.improved_passes)));
+			instrument_cols.insert(instrument_cols.begin(), multistart_cols.begin(), multistart_cols.end());
+
+			if (!cache_hit)
+				std::cout << "[MULTISTART] " << clean_dfg_name << ": latency " << actualLatency << " (deterministic " << multistart_stats.deterministic_latency << "), "
+					<< (multistart_stats.best_pass > 0 ? "seed " + to_string(multistart_stats.seed) : string("deterministic pass")) << ", "
+					<< multistart_stats.improved_passes << " of " << multistart_stats.passes << " passes better, " << multistart_stats.search_ms << " ms" << endl;
+		}
+
+		// Portfolio: the member kept and the outcome of every member
+		if (portfolio) {
+			string members;
+			for (size_t k = 0; k < portfolio_runs.size(); k++) {
+				const PortfolioRun& member_run = portfolio_runs[k];
+				members += (k ? ";" : "") + member_run.member.name + ":";
+				if (member_run.finished)
+					members += to_string(member_run.actualLatency) + "/" + to_string(member_run.totalFUs) + "/" + to_string_with_precision(member_run.runtime_ms, 3)
+						+ (member_run.feasible ? "" : "/infeasible");
+				else
+					members += "cancelled";
 			}
-			FUAllocationResult[type] = reallyUsedFUs;
+
+			std::vector<std::pair<string, string>> portfolio_cols;
+			portfolio_cols.push_back(std::make_pair("Portfolio_Winner", portfolio_winner >= 0 ? portfolio_runs[portfolio_winner].member.name : ""));
+			portfolio_cols.push_back(std::make_pair("Portfolio_Members", members));
+			instrument_cols.insert(instrument_cols.begin(), portfolio_cols.begin(), portfolio_cols.end());
+
+			if (!cache_hit && portfolio_winner >= 0)
+				std::cout << "[PORTFOLIO] " << clean_dfg_name << ": " << portfolio_runs[portfolio_winner].member.name << " kept, latency " << actualLatency
+					<< " (lower bound " << portfolio_bound << ")" << endl;
 		}
 
-		int total_FUs = 0;
+		// Optimality_Gap: (latency - bound) / bound, 0 for a schedule proven optimal. The bound only holds for schedules
+		// within the resource constraints: none for an FDS schedule without a feasible LC, which uses more FUs
+		bool within_constraints = true;
+		for (const auto& fu : FUAllocationResult)
+			if (fu.first >= 0 && fu.first < static_cast<int>(res_constr.size()) && fu.second > res_constr[fu.first])
+				within_constraints = false;
+
+		std::vector<std::pair<string, string>> bound_cols;
+		bound_cols.push_back(std::make_pair("Lower_Bound", to_string(latency_bound.latency)));
+		bound_cols.push_back(std::make_pair("Optimality_Gap", latency_bound.latency > 0 && actualLatency > 0 && within_constraints
+			? to_string_with_precision(static_cast<double>(actualLatency - latency_bound.latency) / latency_bound.latency, 4) : ""));
+		instrument_cols.insert(instrument_cols.begin(), bound_cols.begin(), bound_cols.end());
+
+		if (!cache_dir.empty()) {
+			// a result that depends on the timing is not stored: a time budget that ran out, or portfolio members cancelled
+			bool timing_dependent = (bb && bb_stats.timed_out)
+				|| (portfolio && std::any_of(portfolio_runs.begin(), portfolio_runs.end(), [](const PortfolioRun& r) { return !r.finished; }));
+
+			if (!cache_hit && !timing_dependent) {
+				CachedSchedule entry;
+				entry.actualLatency = actualLatency;
+				entry.runtime_ms = runtime_ms;
+				entry.schlResult = schlResult;
+				entry.FUAllocationResult = FUAllocationResult;
+				entry.bindingResult = bindingResult;
+				cache_store(cache_key, entry);
+			}
+
+			instrument_cols.push_back(std::make_pair("Cache", cache_hit ? "HIT" : (timing_dependent ? "NOT_STORED" : "MISS")));
+		}
 
 		//the following part until the end is the output-file function which is used to generate output-files for checker.
 
 		std::map<int, int> opBindingResult;
-		opBindingResult.clear();
-
-		int curr_idx = 0;
-		int totalFUs = 0;
-
-		for (auto type = 0; type < FUAllocationResult.size(); type++){
-			int numOfFUs = FUAllocationResult[type];
-			totalFUs += numOfFUs;
-			for (auto fu = 0; fu < numOfFUs; fu++) 
-				for (auto op = bindingResult[type][fu].begin(); op != bindingResult[type][fu].end(); op++) 
-					opBindingResult[*op] = fu + curr_idx;
-			curr_idx += numOfFUs;
-		}
+		int totalFUs = BindOperations(FUAllocationResult, bindingResult, opBindingResult);
 
 		cout << endl;
 		cout << endl;
@@ -259,6 +723,7 @@ int main(int argc, char** argv)
 		// Dynamically create filename based on features and mode 
 
 		string output_dir = "Results/" + to_string_with_precision(res_scaling_factor, 2) + "/";
+		MAKE_DIR("Results");
 		MAKE_DIR(output_dir.c_str());
 
 		stringstream ssFileName;
@@ -282,6 +747,8 @@ int main(int argc, char** argv)
 		
 		// END IMPLEMENTED BY SILVIA
 
+		TraceScope output_trace("write_results", "io");
+
 		output_sb_result.open(output_sb_res, ios::out);
 
 
@@ -316,8 +783,17 @@ int main(int argc, char** argv)
 			output_sb_result << i << " " << schlResult[i] << " " << opBindingResult[i] << endl;
 		}
 
+		output_trace.end();
+
+		// Validate the produced schedule without going through the result file
+		if (verify && !VerifyResult(ops, opn, schlResult, opBindingResult, FUAllocationResult, actualLatency, delay, res_constr, res_type, DFGname, debug))
+			verify_failures++;
+
 		// Write results to a CSV file
-        WriteResultToCSV(algName, DFGname, data_type, featS, featP, constraints_db[clean_dfg_name].targetLatency, actualLatency, totalFUs, runtime_ms, res_scaling_factor, ls_base);
+		TRACE_SCOPE("write_csv", "io");
+        WriteResultToCSV(algName, DFGname, data_type, featS, featP, constraints_db[clean_dfg_name].targetLatency, actualLatency, totalFUs, runtime_ms, res_scaling_factor, ls_base, instrument_cols);
+
+		perf_flush(DFGname);
         
 
 		// END IMPLEMENTED BY SILVIA, UPDATED BY PLEASE
@@ -330,6 +806,17 @@ int main(int argc, char** argv)
 
 	std::cout << "All DFGs are done." << endl;
 
+	if (!trace_file.empty())
+		trace_write(trace_file);
+
+	perf_close();
+
+	if (verify) {
+		std::cout << "[VERIFY] " << verify_failures << " schedule(s) failed verification." << endl;
+		if (verify_failures > 0)
+			return 1;
+	}
+
 	return 0;
 }
 
@@ -347,47 +834,161 @@ std::string to_string_with_precision(float value, int n_decimals) {
 
 
 
-// Function to load resource constraints from a file 
-void LoadConstraints(const string& filename, std::map<string, ConstraintData>& db) {
+// Function to verify a produced S&B solution in memory, with the checks of the checker
+bool VerifyResult(std::map<int, G_Node>& ops, int opn, std::map<int, int>& schlResult, std::map<int, int>& opBindingResult, std::map<int, int>& FUAllocationResult,
+	int actualLatency, std::vector<int>& delay, std::vector<int>& res_constr, std::vector<string>& res_type, string DFGname, bool debug)
+{
+	std::vector<int> op_type, start(opn), fu(opn);
+	std::vector<std::pair<int, int>> edges;
 
-	// Open the file
-    ifstream fin(filename);
+	flatten_graph(ops, opn, op_type, edges);
 
-    if (!fin.is_open()) {
-        cerr << "Error: cannot open constraint file " << filename << endl;
-        return;
-    }
+	for (int i = 0; i < opn; i++) {
+		start[i] = schlResult[i];
+		fu[i] = opBindingResult[i];
+	}
 
-    string line;
+	// FU types as they would be written in the result file
+	std::map<int, string> FU_type;
+	std::map<int, int> rc, reported_FUs;
 
-    while (getline(fin, line)) {
-        if (line.empty() || line.rfind("//", 0) == 0) continue;
-        stringstream ss(line);
-        string name;
-        int target, a, m, d, s;
+	for (int t = 0; t < static_cast<int>(delay.size()); t++) {
+		std::string typeName = res_type[t];
+		std::transform(typeName.begin(), typeName.end(), typeName.begin(), ::toupper);
 
-		// Read target delay and constraints for each FU type
-        ss >> name >> target >> a >> m >> d >> s; 
+		FU_type[t] = typeName;
+		rc[t] = res_constr[t];
+		reported_FUs[t] = FUAllocationResult[t];
+	}
 
-		// If reading was successful, store in db
-        if (!ss.fail()) {
-            db[name] = { target, {a, m, d, s} };
-        }
-    }
+	VerifyReport report;
+	verify_schedule(op_type, edges, start, fu, delay, FU_type, rc, reported_FUs, actualLatency, debug, report);
+
+	if (report.total_errors == 0)
+		std::cout << "[VERIFY] " << DFGname << ": PASS" << endl;
+	else
+		std::cout << "[VERIFY] " << DFGname << ": FAIL (" << report.total_errors << " errors: "
+			<< report.dependency_errors << " dependency, " << report.fu_overlap_errors << " FU overlap, "
+			<< report.resource_errors << " resource, " << report.latency_errors << " latency)" << endl;
+
+	return report.total_errors == 0;
+}
+
+
+
+// Keep only the FUs really used in FUAllocationResult and number the FUs of all the types one after the other:
+// opBindingResult[op] = global FU-ID of op, as written in the result file. Returns the total # of FUs used.
+int BindOperations(std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, std::map<int, int>& opBindingResult)
+{
+	for (int type = 0; type < static_cast<int>(FUAllocationResult.size()); type++){
+		int reallyUsedFUs = 0;
+		int numOfFUs = FUAllocationResult[type];
+		
+		for (auto fu = 0; fu < numOfFUs; fu++) {
+			if (bindingResult.count(type) && 
+				bindingResult[type].count(fu) && 
+				!bindingResult[type][fu].empty()) {
+				reallyUsedFUs++;
+			}
+		}
+		FUAllocationResult[type] = reallyUsedFUs;
+	}
 
-	// Close the file
-    fin.close();
+	opBindingResult.clear();
+
+	int curr_idx = 0;
+	int totalFUs = 0;
+
+	for (int type = 0; type < static_cast<int>(FUAllocationResult.size()); type++){
+		int numOfFUs = FUAllocationResult[type];
+		totalFUs += numOfFUs;
+		for (auto fu = 0; fu < numOfFUs; fu++) 
+			for (auto op = bindingResult[type][fu].begin(); op != bindingResult[type][fu].end(); op++) 
+				opBindingResult[*op] = fu + curr_idx;
+		curr_idx += numOfFUs;
+	}
+
+	return totalFUs;
 }
 
 
 
+// Fields of one CSV line (the result CSVs have no quoted fields)
+static std::vector<string> SplitCSVLine(string line)
+{
+	if (!line.empty() && line.back() == '\r')
+		line.pop_back();
+
+	std::vector<string> fields;
+	stringstream ss(line);
+	string field;
+	while (getline(ss, field, ','))
+		fields.push_back(field);
+	if (!line.empty() && line.back() == ',')
+		fields.push_back("");
+	return fields;
+}
+
+// Columns of the CSV file fileName, once its rows are moved to the given columns if its header has other ones.
+// A file whose header starts with the given columns is left as it is (columns added later, like the checker status).
+// Otherwise every row keeps its values under the column of the same name, gets empty values in the new columns, and
+// the old columns not written any more stay at the end, so that the rows appended next have the fields of the header.
+static std::vector<string> MigrateCSVColumns(const string& fileName, const std::vector<string>& columns)
+{
+	ifstream existing(fileName);
+	string line;
+	if (!getline(existing, line))
+		return columns;
+
+	std::vector<string> old_columns = SplitCSVLine(line);
+	if (old_columns.size() >= columns.size() && std::equal(columns.begin(), columns.end(), old_columns.begin()))
+		return old_columns;
+
+	std::vector<string> new_columns = columns;
+	for (const auto& column : old_columns)
+		if (std::find(new_columns.begin(), new_columns.end(), column) == new_columns.end())
+			new_columns.push_back(column);
+
+	// source[i]: column of the old rows that goes to column i, -1 for a new column
+	std::vector<int> source(new_columns.size(), -1);
+	for (size_t i = 0; i < new_columns.size(); i++) {
+		auto it = std::find(old_columns.begin(), old_columns.end(), new_columns[i]);
+		if (it != old_columns.end())
+			source[i] = static_cast<int>(it - old_columns.begin());
+	}
+
+	stringstream migrated;
+	for (size_t i = 0; i < new_columns.size(); i++)
+		migrated << (i ? "," : "") << new_columns[i];
+	migrated << "\n";
+
+	int rows = 0;
+	while (getline(existing, line)) {
+		std::vector<string> fields = SplitCSVLine(line);
+		if (fields.empty())
+			continue;
+		for (size_t i = 0; i < new_columns.size(); i++)
+			migrated << (i ? "," : "") << (source[i] >= 0 && source[i] < static_cast<int>(fields.size()) ? fields[source[i]] : "");
+		migrated << "\n";
+		rows++;
+	}
+	existing.close();
+
+	ofstream rewritten(fileName, std::ios_base::trunc);
+	rewritten << migrated.str();
+	cerr << "Warning: the columns of " << fileName << " changed, its " << rows << " rows were moved to the new header." << endl;
+	return new_columns;
+}
+
 // Function to write results to a CSV file
-void WriteResultToCSV(string algName, string dfgName, string data_type, bool featS, bool featP, int targetLat, int actualLat, int totalFUs, double runtimeMs, double res_scaling_factor, bool ls_base)
+void WriteResultToCSV(string algName, string dfgName, string data_type, bool featS, bool featP, int targetLat, int actualLat, int totalFUs, double runtimeMs, double res_scaling_factor, bool ls_base,
+	const std::vector<std::pair<string, string>>& extra_columns)
 {    
     // Dynamically create filename based on features and mode 
     string clean_data_type = data_type.substr(1);
     
 	string output_dir = "CSV/" + to_string_with_precision(res_scaling_factor, 2) + "/";
+	MAKE_DIR("CSV");
 	MAKE_DIR(output_dir.c_str());
 
     stringstream ssFileName;
@@ -410,17 +1011,26 @@ void WriteResultToCSV(string algName, string dfgName, string data_type, bool fea
 	printf("Writing results to CSV file: %s\n", ssFileName.str().c_str());
     
     string fileName = ssFileName.str();
-    
+
+    std::vector<string> columns = { "DFG_Name", "Target_Latency(FALLS)", "Actual_Latency(Project)", "Delta", "Status", "FUs_Used", "Runtime_ms" };
+    for (const auto& column : extra_columns)
+        columns.push_back(column.first);
+
+    // a file written with other columns (older version, instrumented build) is moved to these ones first
+    std::vector<string> file_columns = MigrateCSVColumns(fileName, columns);
+
     // Open the CSV file in append mode
     ofstream csvFile;
     csvFile.open(fileName, std::ios_base::app);
-    
+
     // If new/empty file write the header
     csvFile.seekp(0, ios::end);
     if (csvFile.tellp() == 0) {
-        csvFile << "DFG_Name,Target_Latency(FALLS),Actual_Latency(Project),Delta,Status,FUs_Used,Runtime_ms\n";
+        for (size_t i = 0; i < columns.size(); i++)
+            csvFile << (i ? "," : "") << columns[i];
+        csvFile << "\n";
     }
-    
+
     // Calculate status: if achieved better or equal latency than target it's a PASS
     string status = (actualLat <= targetLat) ? "PASS" : "FAIL";
     if (targetLat == -1) status = "NO_DATA";
@@ -432,9 +1042,94 @@ void WriteResultToCSV(string algName, string dfgName, string data_type, bool fea
             << (actualLat - targetLat) << ","
             << status << ","
             << totalFUs << ","
-			<< runtimeMs << "\n";
+			<< runtimeMs;
+    for (const auto& column : extra_columns)
+        csvFile << "," << column.second;
+    for (size_t i = columns.size(); i < file_columns.size(); i++)
+        csvFile << ",";
+    csvFile << "\n";
             
     csvFile.close();
 }
 
-// END IMPLEMENTED BY SILVIA
\ No newline at end of file
+// END IMPLEMENTED BY SILVIA
+
+// Schedule one DFG file in streaming order without loading it (see StreamLS.cpp).
+// The result file has the usual format and is written to Results/<scale>/Stream/ so that it does not
+// replace the standard LS result of the same DFG; the CSV line goes to Results_StreamLS_<type>.csv.
+int RunStreamLS(const string& dfg_file, int window, std::map<string, ConstraintData>& constraints_db, std::vector<int>& delay,
+	std::vector<string>& res_type, string data_type, double res_scaling_factor, bool debug)
+{
+	// DFG name: file name without directory and extension, constraints are looked up without the "_4type..." suffix
+	string DFGname = dfg_file.substr(dfg_file.find_last_of("/\\") + 1);
+	if (DFGname.find('.') != string::npos)
+		DFGname = DFGname.substr(0, DFGname.find('.'));
+
+	string clean_dfg_name = DFGname;
+	if (clean_dfg_name.find("_4type") != string::npos)
+		clean_dfg_name = clean_dfg_name.substr(0, clean_dfg_name.find("_4type"));
+
+	if (!constraints_db.count(clean_dfg_name)) {
+		cerr << "Error: No resource constraints found for DFG " << clean_dfg_name << "." << endl;
+		return 1;
+	}
+
+	std::vector<int> res_constr = constraints_db[clean_dfg_name].resources;
+
+	for (auto& rc : res_constr) {
+		rc = static_cast<int>(rc * res_scaling_factor);
+		if (rc < 1) rc = 1;
+	}
+
+	MAKE_DIR("Results");
+	string output_dir = "Results/" + to_string_with_precision(res_scaling_factor, 2) + "/";
+	MAKE_DIR(output_dir.c_str());
+	output_dir += "Stream/";
+	MAKE_DIR(output_dir.c_str());
+
+	string output_sb_res = output_dir + "Results_LS_" + DFGname + ".txt";
+
+	StreamStats stats;
+
+	auto start_time = std::chrono::high_resolution_clock::now();
+
+	if (!StreamLS(dfg_file, DFGname, output_sb_res, delay, res_constr, res_type, window, stats, debug))
+		return 1;
+
+	auto end_time = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double, std::milli> duration = end_time - start_time;
+
+	int totalFUs = 0;
+	for (int used : stats.fus_used)
+		totalFUs += used;
+
+	std::cout << "For the DFG " << DFGname << " (" << stats.opn << " ops, " << stats.edges << " edges), the actual Latency is " << stats.latency
+		<< " (target latency is " << constraints_db[clean_dfg_name].targetLatency << "), # of total FUs used = " << totalFUs
+		<< ", peak # of resident nodes = " << stats.peak_resident << endl;
+
+	WriteResultToCSV("StreamLS", DFGname, data_type, false, false, constraints_db[clean_dfg_name].targetLatency, stats.latency, totalFUs, duration.count(), res_scaling_factor, true);
+
+	return 0;
+}
+
+// Keep the scheduler on the CPU it is running on, so that repeated runs do not migrate between cores
+bool PinToCurrentCPU()
+{
+#ifdef __linux__
+	int cpu = sched_getcpu();
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+	if (cpu < 0 || sched_setaffinity(0, sizeof(set), &set) != 0) {
+		cerr << "Warning: could not pin the scheduler to a CPU, --pin ignored." << endl;
+		return false;
+	}
+
+	std::cout << "Pinned to CPU " << cpu << endl;
+	return true;
+#else
+	cerr << "Warning: --pin is only supported on Linux, ignored." << endl;
+	return false;
+#endif
+}
@@ -0,0 +1,98 @@
+#include "LowerBound.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// (start, tail) threshold pairs evaluated per type for the combined bound. Past it (very deep DFGs with many
+// distinct values), the type only gets the work bound.
+#define LOWER_BOUND_MAX_PAIRS 50000000LL
+
+LatencyBound latency_lower_bound(const DFGGraph& graph, const std::vector<int>& delay, const std::vector<int>& res_constr)
+{
+	LatencyBound bound;
+	int opn = graph.opn;
+	if (opn == 0)
+		return bound;
+
+	// topological order, the ops with no predecessor first
+	vector<int> order, pending(opn);
+	order.reserve(opn);
+	for (int op = 0; op < opn; op++) {
+		pending[op] = graph.parents(op).size();
+		if (pending[op] == 0)
+			order.push_back(op);
+	}
+	for (size_t k = 0; k < order.size(); k++)
+		for (int su : graph.children(order[k]))
+			if (--pending[su] == 0)
+				order.push_back(su);
+
+	if (static_cast<int>(order.size()) != opn) {
+		cerr << "Warning: the DFG has a cycle, no latency lower bound." << endl;
+		return bound;
+	}
+
+	// head: earliest start cycle (ASAP), tail: cycles of dependent work after the op ends
+	vector<int> head(opn, 1), tail(opn, 0);
+	for (int op : order)
+		for (int su : graph.children(op))
+			head[su] = std::max(head[su], head[op] + delay[graph.type[op]]);
+	for (int k = opn - 1; k >= 0; k--) {
+		int op = order[k];
+		for (int su : graph.children(op))
+			tail[op] = std::max(tail[op], delay[graph.type[su]] + tail[su]);
+	}
+
+	vector<vector<int>> ops_of_type(delay.size());
+	for (int op = 0; op < opn; op++) {
+		bound.critical_path = std::max(bound.critical_path, head[op] + delay[graph.type[op]] - 1);
+		ops_of_type[graph.type[op]].push_back(op);
+	}
+
+	for (size_t type = 0; type < delay.size(); type++) {
+		vector<int>& ops = ops_of_type[type];
+		if (ops.empty() || type >= res_constr.size() || res_constr[type] <= 0)
+			continue;
+
+		long long d = delay[type], rc = res_constr[type];
+		// an FU runs whole ops one after the other: the busiest one runs ceil(count / rc) of them
+		auto cycles = [&](long long count) { return static_cast<int>((count + rc - 1) / rc * d); };
+
+		bound.work = std::max(bound.work, cycles(ops.size()));
+
+		vector<int> tails;
+		tails.reserve(ops.size());
+		for (int op : ops)
+			tails.push_back(tail[op]);
+		std::sort(tails.begin(), tails.end());
+		tails.erase(std::unique(tails.begin(), tails.end()), tails.end());
+
+		// ops by decreasing head: each group of equal heads widens the subsets {head >= a}
+		std::sort(ops.begin(), ops.end(), [&](int x, int y) { return head[x] > head[y]; });
+
+		long long heads = 1;
+		for (size_t k = 1; k < ops.size(); k++)
+			heads += head[ops[k]] != head[ops[k - 1]];
+		if (heads * static_cast<long long>(tails.size()) > LOWER_BOUND_MAX_PAIRS)
+			continue;
+
+		vector<long long> count(tails.size(), 0);
+		for (size_t k = 0; k < ops.size(); ) {
+			int a = head[ops[k]];
+			for (; k < ops.size() && head[ops[k]] == a; k++)
+				count[std::lower_bound(tails.begin(), tails.end(), tail[ops[k]]) - tails.begin()]++;
+
+			// subsets {head >= a, tail >= b}, b going down
+			long long members = 0;
+			for (int j = static_cast<int>(tails.size()) - 1; j >= 0; j--) {
+				members += count[j];
+				if (members > 0)
+					bound.combined = std::max(bound.combined, a - 1 + cycles(members) + tails[j]);
+			}
+		}
+	}
+
+	bound.latency = std::max({ bound.critical_path, bound.work, bound.combined });
+	return bound;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// Resource-constrained lower bounds of the latency of a DFG (cycles 1..L, an op holds its FU for its whole delay).
+// No schedule meeting the resource constraints can finish earlier, so a schedule at the bound is optimal:
+// LS_outer_loop stops there, the portfolio cancels its other members, and the CSV rows report the gap to it.
+//
+//  - critical path: the ASAP latency, resources ignored;
+//  - work: for every type, its ops spread over its FUs, ceil(n_t / rc_t) * d_t cycles (an FU runs whole ops);
+//  - combined (Rim and Jain): for every type and every subset S of its ops that cannot start before cycle a and
+//    are followed by at least b cycles of dependent work, a - 1 + ceil(|S| / rc_t) * d_t + b. The subsets are the
+//    ones given by thresholds on the earliest start and on the tail of the ops, which covers the two bounds above.
+
+#include "LS.h"
+
+#include <vector>
+
+struct LatencyBound
+{
+	int critical_path = 0;
+	int work = 0;
+	int combined = 0;
+	int latency = 0;		// the largest of the three
+};
+
+LatencyBound latency_lower_bound(const DFGGraph& graph, const std::vector<int>& delay, const std::vector<int>& res_constr);
@@ -0,0 +1,155 @@
+#include "MultiStart.h"
+#include "LowerBound.h"
+#include "Instrument.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <mutex>
+
+using namespace std;
+
+// The exponents of the first priority are drawn in [1 / range, range], epsilon in [1e-4 / range, 1e-4 * range],
+// uniformly on a log scale
+#define MULTISTART_WEIGHT_RANGE 2.0
+#define MULTISTART_EPS_RANGE 10.0
+
+void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP);
+void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool featS, bool featP);
+
+// uniform in [1 / range, range] on a log scale, from the raw 32-bit output of the generator (the std distributions
+// differ from one standard library to the next, the seeds would not give the same passes everywhere)
+static double draw_factor(std::mt19937& rng, double range)
+{
+	double u = rng() / 4294967296.0;
+	return std::exp((2.0 * u - 1.0) * std::log(range));
+}
+
+// FUs with at least one op bound to them (the FUs_Used of the CSV)
+static int used_FUs(const std::map<int, std::map<int, std::vector<int>>>& bindingResult)
+{
+	int fus = 0;
+	for (const auto& [type, bound] : bindingResult)
+		for (const auto& [fu, ops] : bound)
+			if (!ops.empty())
+				fus++;
+	return fus;
+}
+
+// fewest FUs of a schedule with the given latency: an FU runs at most latency / delay ops of its type
+static int min_FUs(const DFGGraph& graph, const std::vector<int>& delay, int latency)
+{
+	vector<int> count(delay.size(), 0);
+	for (int op = 0; op < graph.opn; op++)
+		if (graph.type[op] >= 0 && graph.type[op] < static_cast<int>(delay.size()))
+			count[graph.type[op]]++;
+
+	int fus = 0;
+	for (size_t t = 0; t < delay.size(); t++) {
+		if (count[t] == 0)
+			continue;
+		int per_fu = delay[t] > 0 ? latency / delay[t] : count[t];
+		if (per_fu <= 0)
+			return INT_MAX;
+		fus += (count[t] + per_fu - 1) / per_fu;
+	}
+	return fus;
+}
+
+void MultiStart_Schedule(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool ls_base, bool featS, bool featP,
+	int passes, unsigned base_seed, int threads, MultiStartStats& stats)
+{
+	TRACE_SCOPE("MultiStart_Schedule", "ls");
+
+	stats = MultiStartStats();
+	auto start_time = std::chrono::steady_clock::now();
+
+	// no pass can go below the latency bound, nor below the FUs it needs at that latency: once one is at both, the
+	// passes after it cannot be kept and are skipped
+	int lower_bound = latency_lower_bound(graph, delay, res_constr).latency;
+	int lower_bound_FUs = min_FUs(graph, delay, lower_bound);
+	std::atomic<int> first_at_bound(INT_MAX);
+
+	std::mutex best_mutex;
+	int best_pass = -1, best_latency = 0, best_FUs = 0;
+	vector<int> pass_latency(passes, 0);
+	InstrCollector counters;
+
+	const std::atomic<bool>* cancel = schedule_cancel;	//the workers follow the cancellation of the caller
+	parallel_for(passes, threads, [&](int k) {
+		if (k > first_at_bound.load() || (cancel != nullptr && cancel->load()))
+			return;
+
+		schedule_cancel = cancel;
+
+		LSPerturbation perturbation;
+		if (k > 0) {
+			perturbation.rng.seed(base_seed + k - 1);
+			perturbation.alpha = draw_factor(perturbation.rng, MULTISTART_WEIGHT_RANGE);
+			perturbation.beta = draw_factor(perturbation.rng, MULTISTART_WEIGHT_RANGE);
+			perturbation.eps *= draw_factor(perturbation.rng, MULTISTART_EPS_RANGE);
+			ls_perturbation = &perturbation;
+		}
+
+		std::map<int, int> pass_schl, pass_FUs;
+		std::map<int, std::map<int, std::vector<int>>> pass_binding;
+		int latency = 0, latencyConstraint = 0;
+		double pass_parameter = latencyParameter;
+		if (ls_base)
+			LS(pass_schl, pass_FUs, pass_binding, latency,
+				graph, latencyConstraint, pass_parameter, delay, res_constr, false, false, false, false);
+		else
+			LS_outer_loop(pass_schl, pass_FUs, pass_binding, latency,
+				graph, latencyConstraint, pass_parameter, delay, res_constr, false, featS, featP);
+
+		ls_perturbation = nullptr;
+		pass_latency[k] = latency;
+		int fus = used_FUs(pass_binding);
+		counters.collect();
+
+		if (debug) {
+			std::lock_guard<std::mutex> lock(best_mutex);
+			cout << "[MULTISTART] pass " << k << (k > 0 ? " seed " + to_string(base_seed + k - 1) : string(" deterministic"))
+				<< " alpha " << perturbation.alpha << " beta " << perturbation.beta << " eps " << perturbation.eps << ": latency " << latency << ", " << fus << " FUs" << endl;
+		}
+
+		if (latency <= 0)	//cancelled
+			return;
+
+		if (latency <= lower_bound && fus <= lower_bound_FUs) {
+			int first = first_at_bound.load();
+			while (k < first && !first_at_bound.compare_exchange_weak(first, k)) {}
+		}
+
+		// lowest latency, then fewest FUs, then lowest pass: the same schedule whatever the order the passes end in
+		std::lock_guard<std::mutex> lock(best_mutex);
+		if (best_pass < 0 || latency < best_latency
+			|| (latency == best_latency && (fus < best_FUs || (fus == best_FUs && k < best_pass)))) {
+			best_pass = k;
+			best_latency = latency;
+			best_FUs = fus;
+			schlResult.swap(pass_schl);
+			FUAllocationResult.swap(pass_FUs);
+			bindingResult.swap(pass_binding);
+			actualLatency = latency;
+		}
+	});
+	counters.merge();
+
+	for (int k = 0; k < passes; k++) {
+		stats.passes += pass_latency[k] > 0;
+		stats.improved_passes += k > 0 && pass_latency[k] > 0 && pass_latency[k] < pass_latency[0];
+	}
+	stats.deterministic_latency = pass_latency[0];
+	stats.best_pass = std::max(best_pass, 0);
+	stats.seed = best_pass > 0 ? base_seed + best_pass - 1 : 0;
+
+	std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start_time;
+	stats.search_ms = duration.count();
+}
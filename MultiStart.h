@@ -0,0 +1,28 @@
+#pragma once
+
+// Multi-start list scheduling (--multistart=N): N passes of the selected LS (base LS, or LS_outer_loop with featS /
+// featP) schedule the same DFG in parallel and the best schedule is kept: lowest latency, then fewest FUs, then
+// lowest pass. Pass 0 is the deterministic LS, so the result is never worse than it. Pass k > 0 runs with the seed
+// base_seed + k - 1 (ls_perturbation): random order among the ops the priorities leave tied, and first priority
+// exponents and epsilon drawn around their defaults. The passes reuse the LS buffers of their thread, so one pass
+// costs about one LS run. The kept schedule does not depend on the # of threads or on their timing.
+
+#include "LS.h"
+
+#include <map>
+#include <vector>
+
+struct MultiStartStats
+{
+	int passes = 0;					// passes run
+	int best_pass = 0;				// pass of the kept schedule, 0: the deterministic LS
+	unsigned seed = 0;				// seed of the kept schedule (0 when it is the one of pass 0)
+	int deterministic_latency = 0;	// latency of pass 0
+	int improved_passes = 0;		// passes with a lower latency than pass 0
+	double search_ms = 0;			// wall time of the passes
+};
+
+// threads <= 0: one per core.
+void MultiStart_Schedule(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool ls_base, bool featS, bool featP,
+	int passes, unsigned base_seed, int threads, MultiStartStats& stats);
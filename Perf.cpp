@@ -0,0 +1,199 @@
+#include "Perf.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#define PERF_NUM_EVENTS 6
+
+static const char* event_names[PERF_NUM_EVENTS] = { "Cycles", "Instructions", "L1D_Misses", "LLC_Misses", "Branch_Misses", "Task_Clock_ms" };
+static const char* phase_names[PERF_NUM_PHASES] = { "LS", "priority", "FDS", "verify", "BB" };
+
+std::atomic<bool> perf_on(false);
+
+struct PerfTotals
+{
+	std::atomic<unsigned long long> calls{ 0 };
+	std::atomic<unsigned long long> value[PERF_NUM_EVENTS] = {};
+};
+
+static PerfTotals totals[PERF_NUM_PHASES];
+static std::atomic<bool> event_available[PERF_NUM_EVENTS] = {};
+static ofstream perf_out;
+
+// Counters of one thread: a single group, read with one system call
+struct PerfThread
+{
+	bool opened = false;
+	int leader = -1;
+	int fd[PERF_NUM_EVENTS];
+	int slot[PERF_NUM_EVENTS];		//position of the event in the group read, -1 if it could not be opened
+	int members = 0;
+
+	~PerfThread()
+	{
+#ifdef __linux__
+		for (int e = 0; e < PERF_NUM_EVENTS; e++)
+			if (opened && fd[e] >= 0)
+				close(fd[e]);
+#endif
+	}
+};
+
+static thread_local PerfThread perf_thread;
+
+static void open_counters(PerfThread& t)
+{
+	t.opened = true;
+	for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+		t.fd[e] = -1;
+		t.slot[e] = -1;
+	}
+
+#ifdef __linux__
+	const unsigned long long l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+	const unsigned int type[PERF_NUM_EVENTS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE };
+	const unsigned long long config[PERF_NUM_EVENTS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, l1d_read_miss,
+		PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_TASK_CLOCK };
+
+	for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type[e];
+		attr.config = config[e];
+		attr.read_format = PERF_FORMAT_GROUP;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		// calling thread, any CPU
+		int fd = syscall(SYS_perf_event_open, &attr, 0, -1, t.leader, 0);
+		if (fd < 0)
+			continue;
+
+		if (t.leader < 0)
+			t.leader = fd;
+		t.fd[e] = fd;
+		t.slot[e] = t.members++;
+		event_available[e].store(true, std::memory_order_relaxed);
+	}
+#endif
+}
+
+static void read_counters(PerfThread& t, unsigned long long* values)
+{
+	for (int e = 0; e < PERF_NUM_EVENTS; e++)
+		values[e] = 0;
+
+#ifdef __linux__
+	if (t.leader < 0)
+		return;
+
+	// PERF_FORMAT_GROUP: # of events, then one value per event in the order they were added
+	unsigned long long buffer[PERF_NUM_EVENTS + 1];
+	if (read(t.leader, buffer, sizeof(buffer)) < static_cast<ssize_t>((t.members + 1) * sizeof(unsigned long long)))
+		return;
+
+	for (int e = 0; e < PERF_NUM_EVENTS; e++)
+		if (t.slot[e] >= 0)
+			values[e] = buffer[1 + t.slot[e]];
+#endif
+}
+
+void PerfScope::begin()
+{
+	if (!perf_thread.opened)
+		open_counters(perf_thread);
+
+	read_counters(perf_thread, start);
+}
+
+void PerfScope::finish()
+{
+	unsigned long long end[PERF_NUM_EVENTS];
+	read_counters(perf_thread, end);
+
+	PerfTotals& total = totals[phase];
+	total.calls.fetch_add(1, std::memory_order_relaxed);
+	for (int e = 0; e < PERF_NUM_EVENTS; e++)
+		total.value[e].fetch_add(end[e] - start[e], std::memory_order_relaxed);
+}
+
+bool perf_open(const std::string& filename)
+{
+	perf_out.open(filename, ios::out);
+	if (!perf_out.is_open()) {
+		cerr << "Error: cannot write perf counter file " << filename << endl;
+		return false;
+	}
+
+	perf_out << "Name,Phase,Calls";
+	for (int e = 0; e < PERF_NUM_EVENTS; e++)
+		perf_out << "," << event_names[e];
+	perf_out << ",IPC\n";
+
+	// Open the counters of the calling thread now, to report the missing ones once
+	if (!perf_thread.opened)
+		open_counters(perf_thread);
+
+	string missing;
+	for (int e = 0; e < PERF_NUM_EVENTS; e++)
+		if (!event_available[e].load())
+			missing += string(missing.empty() ? "" : ", ") + event_names[e];
+
+	if (!missing.empty())
+		cerr << "Warning: performance counters not available (" << missing << "), their columns are left empty." << endl;
+
+	perf_on.store(true);
+	return true;
+}
+
+void perf_flush(const std::string& label)
+{
+	if (!perf_out.is_open())
+		return;
+
+	for (int p = 0; p < PERF_NUM_PHASES; p++) {
+		unsigned long long calls = totals[p].calls.exchange(0);
+		unsigned long long value[PERF_NUM_EVENTS];
+		for (int e = 0; e < PERF_NUM_EVENTS; e++)
+			value[e] = totals[p].value[e].exchange(0);
+
+		if (calls == 0)
+			continue;
+
+		perf_out << label << "," << phase_names[p] << "," << calls;
+		for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+			perf_out << ",";
+			if (!event_available[e].load())
+				continue;
+			if (e == PERF_NUM_EVENTS - 1)
+				perf_out << value[e] / 1e6;		//task clock is in ns
+			else
+				perf_out << value[e];
+		}
+
+		perf_out << ",";
+		if (event_available[0].load() && event_available[1].load() && value[0] > 0)
+			perf_out << static_cast<double>(value[1]) / value[0];
+		perf_out << "\n";
+	}
+
+	perf_out.flush();
+}
+
+void perf_close()
+{
+	perf_on.store(false);
+	if (perf_out.is_open())
+		perf_out.close();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+// Optional hardware performance counters (Linux perf_event_open) around the scheduling phases:
+// cycles, instructions, L1D read misses, LLC misses and branch misses, plus the task clock.
+// Counting is off until perf_open() is called (--perf=<file>); while it is off a PERF_SCOPE costs one
+// relaxed atomic load. Counters the kernel refuses (perf_event_paranoid, virtual machines without a PMU,
+// other systems than Linux) are left empty in the output instead of failing the run.
+//
+// Counters are per thread and opened by each thread on its first scope; the totals are shared atomics.
+// Scopes are inclusive: the LS phase contains the priority calls made by LS().
+
+#include <atomic>
+#include <string>
+
+enum PerfPhase
+{
+	PERF_LS,			// LS() passes
+	PERF_PRIORITY,		// calculate_priorities
+	PERF_FDS,			// FDS()
+	PERF_VERIFY,		// verify_schedule (checker and --verify)
+	PERF_BB,			// BB_Schedule search (without its LS run)
+	PERF_NUM_PHASES
+};
+
+extern std::atomic<bool> perf_on;
+
+bool perf_open(const std::string& filename);	//starts counting, rows go to filename (CSV)
+void perf_flush(const std::string& label);		//writes one row per measured phase for label and clears the totals
+void perf_close();
+
+class PerfScope
+{
+public:
+	explicit PerfScope(PerfPhase phase) : phase(phase), active(perf_on.load(std::memory_order_relaxed))
+	{
+		if (active)
+			begin();
+	}
+
+	~PerfScope()
+	{
+		if (active)
+			finish();
+	}
+
+	PerfScope(const PerfScope&) = delete;
+	PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+	void begin();
+	void finish();
+
+	PerfPhase phase;
+	bool active;
+	unsigned long long start[8];
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+#define PERF_SCOPE(phase) PerfScope PERF_CONCAT(perf_scope_, __LINE__)(phase)
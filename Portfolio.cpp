@@ -0,0 +1,148 @@
+#include "Portfolio.h"
+#include "LowerBound.h"
+#include "Instrument.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+void LS(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool improvedSolution, bool debug, bool featS, bool featP);
+void LS_outer_loop(std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult, int& actualLatency,
+	const DFGGraph& graph, int& latencyConstraint, double& latencyParameter, std::vector<int>& delay, std::vector<int>& res_constr, bool debug, bool featS, bool featP);
+bool FDS_Outer_Loop(const DFGGraph& graph, std::vector<NodeState>& state, std::vector<int>& delay, int& LC, double& latencyParameter, std::vector<int>& res_constr, bool debug, int threads, int lookahead, bool bisect, int probes, int& fds_runs);
+void FDS_Binding(const DFGGraph& graph, const std::vector<NodeState>& state, const std::vector<int>& delay,
+	std::map<int, int>& schlResult, std::map<int, int>& FUAllocationResult, std::map<int, std::map<int, std::vector<int>>>& bindingResult,
+	int& actualLatency);
+
+bool parse_portfolio(const std::string& list, std::vector<PortfolioMember>& members)
+{
+	members.clear();
+
+	stringstream ss(list.empty() ? "ls,fdls_S0_P0,fdls_S1_P1" : list);
+	string token;
+	while (getline(ss, token, ',')) {
+		std::transform(token.begin(), token.end(), token.begin(), ::tolower);
+
+		PortfolioMember member;
+		if (token == "ls") {
+			member.name = "LS";
+			member.engine = "ls";
+		} else if (token == "fds") {
+			member.name = "FDS";
+			member.engine = "fds";
+		} else if (token.size() == 10 && token.compare(0, 6, "fdls_s") == 0 && token.compare(7, 2, "_p") == 0
+			&& (token[6] == '0' || token[6] == '1') && (token[9] == '0' || token[9] == '1')) {
+			member.engine = "fdls";
+			member.featS = token[6] == '1';
+			member.featP = token[9] == '1';
+			member.name = "FDLS_S" + string(1, token[6]) + "_P" + string(1, token[9]);
+		} else {
+			cerr << "Error: unknown portfolio member " << token << " (ls, fdls_S<0|1>_P<0|1> or fds)." << endl;
+			return false;
+		}
+
+		members.push_back(member);
+	}
+
+	if (members.empty()) {
+		cerr << "Error: empty portfolio." << endl;
+		return false;
+	}
+	return true;
+}
+
+static int used_FUs(const std::map<int, std::map<int, std::vector<int>>>& bindingResult)
+{
+	int fus = 0;
+	for (const auto& [type, bound] : bindingResult)
+		for (const auto& [fu, ops] : bound)
+			if (!ops.empty())
+				fus++;
+	return fus;
+}
+
+int RunPortfolio(const DFGGraph& graph, std::vector<int>& delay, std::vector<int>& res_constr, double latencyParameter,
+	const std::vector<PortfolioMember>& members, int fds_lookahead, bool fds_bisect, int fds_probes, bool debug,
+	std::vector<PortfolioRun>& runs, int& lower_bound)
+{
+	int count = members.size();
+	runs.assign(count, PortfolioRun());
+	lower_bound = latency_lower_bound(graph, delay, res_constr).latency;
+
+	std::atomic<bool> cancel(false);
+	InstrCollector counters;
+
+	// one thread per member, each with its own copy of the inputs the schedulers take by reference
+	parallel_for(count, count, [&](int k) {
+		PortfolioRun& run = runs[k];
+		run.member = members[k];
+
+		schedule_cancel = &cancel;
+
+		vector<int> my_delay = delay, my_res_constr = res_constr;
+		double my_latencyParameter = latencyParameter;
+		int latencyConstraint = 0;
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+
+		if (run.member.engine == "fds") {
+			vector<NodeState> state;
+			int LC = 0, fds_runs = 0;
+			run.feasible = FDS_Outer_Loop(graph, state, my_delay, LC, my_latencyParameter, my_res_constr, debug, 1, fds_lookahead, fds_bisect, fds_probes, fds_runs);
+			if (!schedule_cancelled())
+				FDS_Binding(graph, state, my_delay, run.schlResult, run.FUAllocationResult, run.bindingResult, run.actualLatency);
+		} else if (run.member.engine == "ls")
+			LS(run.schlResult, run.FUAllocationResult, run.bindingResult, run.actualLatency,
+				graph, latencyConstraint, my_latencyParameter, my_delay, my_res_constr, false, debug, false, false);
+		else
+			LS_outer_loop(run.schlResult, run.FUAllocationResult, run.bindingResult, run.actualLatency,
+				graph, latencyConstraint, my_latencyParameter, my_delay, my_res_constr, debug, run.member.featS, run.member.featP);
+
+		std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start_time;
+		run.runtime_ms = duration.count();
+		counters.collect();
+
+		// a result finished after the cancellation may be incomplete (FDS), it is dropped as well
+		run.finished = !schedule_cancelled() && run.actualLatency > 0;
+		schedule_cancel = nullptr;
+
+		if (run.finished) {
+			run.totalFUs = used_FUs(run.bindingResult);
+			if (run.feasible && run.actualLatency <= lower_bound)
+				cancel.store(true);
+		}
+	});
+	counters.merge();
+
+	int best = -1;
+	for (int k = 0; k < count; k++) {
+		const PortfolioRun& run = runs[k];
+
+		std::cout << "[PORTFOLIO] " << run.member.name << ": ";
+		if (run.finished)
+			std::cout << "latency " << run.actualLatency << ", " << run.totalFUs << " FUs, " << run.runtime_ms << " ms"
+				<< (run.feasible ? "" : " (violates the resource constraints)") << endl;
+		else
+			std::cout << "cancelled after " << run.runtime_ms << " ms" << endl;
+
+		if (!run.finished)
+			continue;
+
+		if (best < 0) {
+			best = k;
+			continue;
+		}
+
+		const PortfolioRun& b = runs[best];
+		if (run.feasible != b.feasible ? run.feasible
+			: run.actualLatency != b.actualLatency ? run.actualLatency < b.actualLatency
+			: run.totalFUs != b.totalFUs ? run.totalFUs < b.totalFUs : run.runtime_ms < b.runtime_ms)
+			best = k;
+	}
+
+	return best;
+}
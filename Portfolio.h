@@ -0,0 +1,45 @@
+#pragma once
+
+// Portfolio mode (--portfolio): several engines and feature combinations schedule the same DFG concurrently, one
+// thread each, all reading the same DFGGraph. The best schedule is kept: lowest latency, then fewest FUs, then
+// shortest runtime. The latency cannot go below latency_lower_bound(), so the first member to finish at the bound
+// cancels the ones still running (schedule_cancel) and their results are dropped: the wall time is about the one
+// of the slowest member, or less. Which member wins a tie on runtime, or is cancelled, depends on the timing.
+
+#include "LS.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct PortfolioMember
+{
+	std::string name;		// as written in the CSV: LS, FDLS_S<0|1>_P<0|1>, FDS
+	std::string engine;		// ls, fdls or fds
+	bool featS = false;
+	bool featP = false;
+};
+
+struct PortfolioRun
+{
+	PortfolioMember member;
+	bool finished = false;		// false: cancelled, no result
+	bool feasible = true;		// false: FDS found no LC meeting the resource constraints, its schedule violates them
+	int actualLatency = 0;
+	int totalFUs = 0;			// FUs with at least one op bound to them
+	double runtime_ms = 0;
+	std::map<int, int> schlResult;
+	std::map<int, int> FUAllocationResult;
+	std::map<int, std::map<int, std::vector<int>>> bindingResult;
+};
+
+// "ls,fdls_S0_P0,fdls_S1_P1,fds" (case insensitive). An empty list gives the default members: base LS, FD-LS S0_P0
+// and FD-LS S1_P1. Returns false, with a message, on an unknown member.
+bool parse_portfolio(const std::string& list, std::vector<PortfolioMember>& members);
+
+// Runs the members, runs[k] is the outcome of members[k]. Returns the index of the best finished run (-1 if none),
+// a feasible one if there is any, and the lower bound the members were cancelled at. The FDS members use the given
+// search options with one thread.
+int RunPortfolio(const DFGGraph& graph, std::vector<int>& delay, std::vector<int>& res_constr, double latencyParameter,
+	const std::vector<PortfolioMember>& members, int fds_lookahead, bool fds_bisect, int fds_probes, bool debug,
+	std::vector<PortfolioRun>& runs, int& lower_bound);
@@ -5,7 +5,7 @@
 * 1: Mul
 *
 */
-#include "ilp.h"
+#include "LS.h"
 
 //this function is used to skip the comment lines.
 inline bool isCommentLine(const string& line) {
@@ -68,6 +68,42 @@ void READ_LIB(const string& file_name,
 	fin.close();
 }
 
+// IMPLEMENTED BY SILVIA
+
+// Function to load resource constraints from a file 
+void LoadConstraints(const string& filename, std::map<string, ConstraintData>& db) {
+
+	// Open the file
+    ifstream fin(filename);
+
+    if (!fin.is_open()) {
+        cerr << "Error: cannot open constraint file " << filename << endl;
+        return;
+    }
+
+    string line;
+
+    while (getline(fin, line)) {
+        if (line.empty() || line.rfind("//", 0) == 0) continue;
+        stringstream ss(line);
+        string name;
+        int target, a, m, d, s;
+
+		// Read target delay and constraints for each FU type
+        ss >> name >> target >> a >> m >> d >> s; 
+
+		// If reading was successful, store in db
+        if (!ss.fail()) {
+            db[name] = { target, {a, m, d, s} };
+        }
+    }
+
+	// Close the file
+    fin.close();
+}
+
+// END IMPLEMENTED BY SILVIA
+
 //DO NOT CHANGE FUNCTIONS BELOW//
 /*
 *
@@ -170,14 +206,6 @@ void readGraphInfo(string& filename, int& edge_num, int& opn, std::map<int, G_No
 	for (auto i = 0; i < opn; i++)
 	{
 		G_Node curr;
-
-		// IMPLEMENTED BY SILVIA
-		curr.criticalSuccessorId = -1; // Initialize criticalSuccessorId
-		curr.priority1 = 0.0f; // Initialize priority1
-		curr.priority2 = 0.0f; // Initialize priority2
-		curr.priority3 = 0; // Initialize priority3
-		// END IMPLEMENTED BY SILVIA
-		
 		ops[i] = curr;
 	}
 
@@ -228,4 +256,100 @@ void readGraphInfo(string& filename, int& edge_num, int& opn, std::map<int, G_No
 
 	fclose(bench);
 	delete[] line;
-}
\ No newline at end of file
+}
+
+// # of operation types of the DFG files: ADD, MUL, DIV, SQRT (the names readGraphInfo knows)
+#define DFG_TYPES 4
+
+/*
+	Read a DFG in the binary format written by the generator (DFGGen.cpp, --binary):
+	"DFGB", version (1), # of nodes, # of edges (little-endian uint32), one type byte per node,
+	then one (parent, child) uint32 pair per edge.
+	ops/opn/edge_num are filled as readGraphInfo does for the text file. Returns false on a malformed file.
+*/
+bool readGraphInfoBinary(string& filename, int& edge_num, int& opn, std::map<int, G_Node>& ops)
+{
+	ifstream fin(filename, ios::in | ios::binary);
+	if (!fin.is_open()) {
+		std::cerr << "Error: Reading input DFG file " << filename << " failed." << endl;
+		return false;
+	}
+
+	auto get_u32 = [&fin]() {
+		unsigned char b[4] = { 0, 0, 0, 0 };
+		fin.read(reinterpret_cast<char*>(b), 4);
+		return uint32_t(b[0]) | (uint32_t(b[1]) << 8) | (uint32_t(b[2]) << 16) | (uint32_t(b[3]) << 24);
+	};
+
+	char magic[4] = { 0, 0, 0, 0 };
+	fin.read(magic, 4);
+	uint32_t version = get_u32();
+	if (!fin || strncmp(magic, "DFGB", 4) != 0 || version != 1) {
+		std::cerr << "Error: " << filename << " is not a binary DFG file." << endl;
+		return false;
+	}
+
+	uint32_t nodes = get_u32();
+	uint32_t edges = get_u32();
+
+	opn = 0;
+	for (uint32_t i = 0; i < nodes && fin; i++)
+	{
+		G_Node curr;
+		curr.id = i;
+		curr.type = fin.get();
+		if (fin && (curr.type < 0 || curr.type >= DFG_TYPES)) {
+			std::cerr << "Error: " << filename << " gives node " << i << " the unknown type " << curr.type
+				<< " (0 = ADD, 1 = MUL, 2 = DIV, 3 = SQRT)." << endl;
+			return false;
+		}
+		ops[i] = curr;
+		opn++;
+	}
+
+	for (uint32_t e = 0; e < edges && fin; e++)
+	{
+		uint32_t pr = get_u32(), su = get_u32();
+		if (!fin || pr >= nodes || su >= nodes) {
+			std::cerr << "Error: " << filename << " has an invalid edge." << endl;
+			return false;
+		}
+
+		(ops[pr].child).push_back(&(ops[su]));
+		(ops[su].parent).push_back(&(ops[pr]));
+		edge_num++;
+	}
+
+	if (!fin) {
+		std::cerr << "Error: " << filename << " is truncated." << endl;
+		return false;
+	}
+
+	return true;
+}
+
+void BuildGraph(const std::map<int, G_Node>& ops, DFGGraph& graph)
+{
+	int opn = ops.size();
+
+	graph.opn = opn;
+	graph.type.assign(opn, 0);
+	graph.child_start.assign(opn + 1, 0);
+	graph.parent_start.assign(opn + 1, 0);
+	graph.child.clear();
+	graph.parent.clear();
+
+	for (int i = 0; i < opn; i++)
+	{
+		const G_Node& node = ops.at(i);
+		graph.type[i] = node.type;
+
+		for (auto su = node.child.begin(); su != node.child.end(); su++)
+			graph.child.push_back((*su)->id);
+		for (auto pr = node.parent.begin(); pr != node.parent.end(); pr++)
+			graph.parent.push_back((*pr)->id);
+
+		graph.child_start[i + 1] = graph.child.size();
+		graph.parent_start[i + 1] = graph.parent.size();
+	}
+}
@@ -0,0 +1,241 @@
+#include "ScheduleCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+
+using namespace std;
+
+// Bump when the entry format or the meaning of the key changes
+#define CACHE_FORMAT 2
+
+static string cache_dir;
+static std::map<string, CachedSchedule> cache_memory;
+static std::mutex cache_mutex;
+
+// FNV-1a, 64 bits, fed with fixed-size little-endian integers so that keys are the same on every platform
+struct KeyHash
+{
+	uint64_t h = 14695981039346656037ULL;
+
+	void add(uint64_t value)
+	{
+		for (int b = 0; b < 8; b++) {
+			h ^= (value >> (8 * b)) & 0xff;
+			h *= 1099511628211ULL;
+		}
+	}
+};
+
+std::string schedule_cache_key(const DFGGraph& graph, const std::vector<int>& delay, const std::vector<int>& res_constr,
+	bool featS, bool featP, bool ls_base, double latencyParameter, const std::string& engine_options)
+{
+	KeyHash k;
+
+	k.add(CACHE_FORMAT);
+
+	k.add(graph.opn);
+	for (int i = 0; i < graph.opn; i++) {
+		k.add(graph.type[i]);
+		k.add(graph.children(i).size());
+		for (int su : graph.children(i))
+			k.add(su);
+	}
+
+	k.add(delay.size());
+	for (int d : delay)
+		k.add(d);
+
+	k.add(res_constr.size());
+	for (int rc : res_constr)
+		k.add(rc);
+
+	uint64_t lp_bits;
+	memcpy(&lp_bits, &latencyParameter, sizeof(lp_bits));
+
+	k.add(featS);
+	k.add(featP);
+	k.add(ls_base);
+	k.add(lp_bits);
+
+	// empty for the LS engines, whose keys stay the ones of the entries written before other engines existed
+	if (!engine_options.empty()) {
+		k.add(engine_options.size());
+		for (unsigned char c : engine_options)
+			k.add(c);
+	}
+
+	char hex[17];
+	snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(k.h));
+	return hex;
+}
+
+bool cache_open(const std::string& dir)
+{
+	std::error_code ec;
+	std::filesystem::create_directories(dir, ec);
+	if (!std::filesystem::is_directory(dir)) {
+		cerr << "Error: cannot create the cache directory " << dir << endl;
+		return false;
+	}
+
+	lock_guard<mutex> lock(cache_mutex);
+	cache_dir = dir;
+	return true;
+}
+
+static string entry_file(const string& key)
+{
+	return (std::filesystem::path(cache_dir) / (key + ".txt")).string();
+}
+
+// Entry file:
+//   LSCACHE <format>
+//   latency <L>
+//   runtime_ms <ms>
+//   schedule <# of ops>, then "<op> <cc>" lines
+//   allocation <# of types>, then "<type> <# of FUs>" lines
+//   binding <# of FUs>, then "<type> <FU> <# of ops> <ops...>" lines
+static bool read_entry(const string& filename, CachedSchedule& entry)
+{
+	ifstream fin(filename);
+	if (!fin.is_open())
+		return false;
+
+	string tag;
+	int format = 0, count = 0;
+
+	if (!(fin >> tag >> format) || tag != "LSCACHE" || format != CACHE_FORMAT)
+		return false;
+	if (!(fin >> tag >> entry.actualLatency) || tag != "latency")
+		return false;
+	if (!(fin >> tag >> entry.runtime_ms) || tag != "runtime_ms")
+		return false;
+
+	if (!(fin >> tag >> count) || tag != "schedule")
+		return false;
+	for (int i = 0; i < count; i++) {
+		int op, cc;
+		if (!(fin >> op >> cc))
+			return false;
+		entry.schlResult[op] = cc;
+	}
+
+	if (!(fin >> tag >> count) || tag != "allocation")
+		return false;
+	for (int i = 0; i < count; i++) {
+		int type, num;
+		if (!(fin >> type >> num))
+			return false;
+		entry.FUAllocationResult[type] = num;
+	}
+
+	if (!(fin >> tag >> count) || tag != "binding")
+		return false;
+	for (int i = 0; i < count; i++) {
+		int type, fu, num;
+		if (!(fin >> type >> fu >> num))
+			return false;
+		vector<int>& ops = entry.bindingResult[type][fu];
+		ops.resize(num);
+		for (int k = 0; k < num; k++)
+			if (!(fin >> ops[k]))
+				return false;
+	}
+
+	return true;
+}
+
+static bool write_entry(const string& filename, const CachedSchedule& entry)
+{
+	// written next to the final name and renamed, so that a parallel run never reads half an entry
+	string tmp_name = filename + ".tmp" + to_string(std::random_device()());
+	{
+		ofstream fout(tmp_name, ios::out);
+		if (!fout.is_open())
+			return false;
+
+		fout << "LSCACHE " << CACHE_FORMAT << "\n";
+		fout << "latency " << entry.actualLatency << "\n";
+		fout << "runtime_ms " << entry.runtime_ms << "\n";
+
+		fout << "schedule " << entry.schlResult.size() << "\n";
+		for (const auto& [op, cc] : entry.schlResult)
+			fout << op << " " << cc << "\n";
+
+		fout << "allocation " << entry.FUAllocationResult.size() << "\n";
+		for (const auto& [type, num] : entry.FUAllocationResult)
+			fout << type << " " << num << "\n";
+
+		int fus = 0;
+		for (const auto& [type, bound] : entry.bindingResult)
+			fus += bound.size();
+
+		fout << "binding " << fus << "\n";
+		for (const auto& [type, bound] : entry.bindingResult)
+			for (const auto& [fu, ops] : bound) {
+				fout << type << " " << fu << " " << ops.size();
+				for (int op : ops)
+					fout << " " << op;
+				fout << "\n";
+			}
+
+		if (!fout.good())
+			return false;
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmp_name, filename, ec);
+	if (ec) {
+		std::filesystem::remove(tmp_name, ec);
+		return false;
+	}
+	return true;
+}
+
+bool cache_lookup(const std::string& key, CachedSchedule& entry)
+{
+	lock_guard<mutex> lock(cache_mutex);
+
+	auto it = cache_memory.find(key);
+	if (it != cache_memory.end()) {
+		entry = it->second;
+		return true;
+	}
+
+	if (cache_dir.empty())
+		return false;
+
+	CachedSchedule stored;
+	if (!read_entry(entry_file(key), stored))
+		return false;
+
+	entry = cache_memory[key] = stored;
+	return true;
+}
+
+void cache_store(const std::string& key, const CachedSchedule& entry)
+{
+	lock_guard<mutex> lock(cache_mutex);
+
+	cache_memory[key] = entry;
+
+	if (!cache_dir.empty() && !write_entry(entry_file(key), entry))
+		cerr << "Warning: cannot write the cache entry " << entry_file(key) << endl;
+}
+
+void cache_discard(const std::string& key)
+{
+	lock_guard<mutex> lock(cache_mutex);
+
+	cache_memory.erase(key);
+
+	std::error_code ec;
+	if (!cache_dir.empty())
+		std::filesystem::remove(entry_file(key), ec);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Content-addressed cache of scheduling results (--cache). The key is a hash of everything the result
+// depends on: the graph (op types and edges), the FU delays, the effective resource constraints (after
+// scaling and clamping, so factors that clamp to the same vector share an entry) and the configuration
+// (featS, featP, ls_base, latencyParameter, and for the other engines a description of their options, e.g. the
+// FDS search). An entry holds the raw scheduler outputs and the runtime of the run that produced it.
+//
+// Entries are kept in memory for the process and written to one file per key in the cache directory,
+// so that later runs and parallel sweeps reuse them. The key does not cover the scheduler code: clear the
+// directory after changing the algorithm.
+
+#include "LS.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct CachedSchedule
+{
+	int actualLatency = 0;
+	double runtime_ms = 0;										//runtime of the run that produced the entry
+	std::map<int, int> schlResult;								//<op, scheduled cc>
+	std::map<int, int> FUAllocationResult;						//<FU type, # of FUs allocated>
+	std::map<int, std::map<int, std::vector<int>>> bindingResult;	//<FU type, <FU, ops bound to it>>
+};
+
+std::string schedule_cache_key(const DFGGraph& graph, const std::vector<int>& delay, const std::vector<int>& res_constr,
+	bool featS, bool featP, bool ls_base, double latencyParameter, const std::string& engine_options = "");
+
+bool cache_open(const std::string& dir);		//enables the cache, entries are read from and written to dir
+bool cache_lookup(const std::string& key, CachedSchedule& entry);
+void cache_store(const std::string& key, const CachedSchedule& entry);
+void cache_discard(const std::string& key);		//drops an entry that failed verification
@@ -0,0 +1,60 @@
+#pragma once
+
+// Summary statistics of repeated timing samples, shared by the benchmark and the scheduler.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+struct SampleStats
+{
+	int count = 0;
+	double min = 0;
+	double max = 0;
+	double mean = 0;
+	double median = 0;
+	double p95 = 0;
+	double stddev = 0;		//sample standard deviation (0 for a single sample)
+};
+
+// Percentile p (0..100) of sorted samples, linear interpolation between the closest ranks
+inline double percentile_sorted(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+
+	double rank = p / 100.0 * (sorted.size() - 1);
+	size_t lo = static_cast<size_t>(std::floor(rank));
+	size_t hi = std::min(lo + 1, sorted.size() - 1);
+
+	return sorted[lo] + (rank - lo) * (sorted[hi] - sorted[lo]);
+}
+
+inline SampleStats summarize(std::vector<double> samples)
+{
+	SampleStats s;
+	s.count = samples.size();
+	if (samples.empty())
+		return s;
+
+	std::sort(samples.begin(), samples.end());
+
+	double sum = 0;
+	for (double v : samples)
+		sum += v;
+
+	s.min = samples.front();
+	s.max = samples.back();
+	s.mean = sum / s.count;
+	s.median = percentile_sorted(samples, 50);
+	s.p95 = percentile_sorted(samples, 95);
+
+	if (s.count > 1) {
+		double sq = 0;
+		for (double v : samples)
+			sq += (v - s.mean) * (v - s.mean);
+		s.stddev = std::sqrt(sq / (s.count - 1));
+	}
+
+	return s;
+}
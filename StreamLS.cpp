@@ -0,0 +1,437 @@
+// Streaming list scheduler for DFGs too large to be held as std::map<int, G_Node>.
+//
+// The input is the usual DFG text format in "streaming order": every node line is followed by the
+// edges that enter it, and those edges only come from nodes declared earlier. The parent set of a
+// node is therefore complete as soon as the next node line (or the end of file) is read.
+//
+// Only a sliding window of the graph is resident: nodes are read until the window is full,
+// list scheduled cycle by cycle, and dropped once they are scheduled and finished. Schedule lines
+// are written out as soon as the operations are scheduled.
+//
+// Priority follows the standard LS (smallest ALAP first): inside the window, ALAP ordering is the
+// same as ordering by the longest delay path to a sink of the window ("height"), largest first.
+
+#include "LS.h"
+
+#include <deque>
+#include <unordered_map>
+
+using namespace std;
+
+// The window grows past --window only while the resident nodes wait for parents that are not read yet, up to this
+// factor: past it the run stops with an error, so that --window bounds the memory
+#define STREAM_MAX_GROWTH 2
+
+
+struct StreamNode
+{
+	string name;		//node name in the DFG file
+	int type;			//node Function-type
+	int pending;		//# of parents not scheduled yet
+	int readyCC;		//earliest cc allowed by the already scheduled parents
+	int schl;			//scheduled cc, 0 if not scheduled yet
+	int height;			//longest delay path to a sink of the window (priority)
+	bool sealed;		//all parents are known
+	vector<int> child;	//resident successor nodes (distance = 1)
+};
+
+
+class StreamScheduler
+{
+public:
+	StreamScheduler(std::vector<int>& delay, std::vector<int>& res_constr, int window, ofstream& ops_out, bool debug)
+		: delay(delay), res_constr(res_constr), window(window), ops_out(ops_out), debug(debug)
+	{
+		int numberOfFunctionType = res_constr.size();
+
+		busy.assign(numberOfFunctionType, vector<int>());
+		ready.assign(numberOfFunctionType, vector<int>());
+		fuOffset.assign(numberOfFunctionType, 0);
+		stats.fus_used.assign(numberOfFunctionType, 0);
+
+		for (int t = 0; t < numberOfFunctionType; t++) {
+			busy[t].assign(std::max(res_constr[t], 1), 0);
+			if (t > 0)
+				fuOffset[t] = fuOffset[t - 1] + std::max(res_constr[t - 1], 1);
+		}
+	}
+
+	bool run(FILE* bench, StreamStats& result);
+
+private:
+	std::vector<int>& delay;
+	std::vector<int>& res_constr;
+	int window;
+	ofstream& ops_out;
+	bool debug;
+
+	FILE* bench = nullptr;
+	bool eof = false;
+	bool error = false;
+	int lineNumber = 0;
+
+	deque<StreamNode> nodes;				//resident window, nodes[i] has ID base + i
+	int base = 0;
+	unordered_map<string, int> nameToId;	//resident nodes only
+
+	int currentClockCycle = 1;
+	int scheduledInWindow = 0;
+
+	vector<vector<int>> busy;		//busy[Function type][an FU] = finishing cc of the FU
+	vector<int> fuOffset;			//global FU-ID of the first FU of each Function type
+	vector<vector<int>> ready;		//ready[Function type] = heap of ready node IDs (by priority)
+	priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> waiting;	//<readyCC, node ID> of nodes with all parents scheduled
+
+	StreamStats stats;
+
+	StreamNode& node(int id) { return nodes[id - base]; }
+	int span() const { return static_cast<int>(nodes.size()); }
+
+	// true if a should be scheduled after b
+	bool lowerPriority(int a, int b) {
+		if (node(a).height != node(b).height)
+			return node(a).height < node(b).height;
+		return a > b;
+	}
+
+	bool readLine();
+	void readNodes(int target_span);
+	void seal(int id);
+	void computeHeights();
+	void releaseWaiting();
+	void scheduleCycle();
+	void evictFinished();
+};
+
+
+// Read and process one line of the DFG file. Returns false at the end of the file.
+bool StreamScheduler::readLine()
+{
+	char line[256];
+	char seps[] = " \t\b\n\r:;";
+
+	if (!fgets(line, sizeof(line), bench)) {
+		eof = true;
+		if (span() > 0 && !nodes.back().sealed)
+			seal(base + span() - 1);
+		return false;
+	}
+	lineNumber++;
+
+	char* label;
+
+	if ((label = strstr(line, "label")) != NULL)	//a new operation node, the previous node has all its parents now
+	{
+		if (span() > 0 && !nodes.back().sealed)
+			seal(base + span() - 1);
+
+		StreamNode curr;
+		char* tok = strtok(line, seps);
+		if (tok == NULL || tok == label) {
+			std::cerr << "Error: DFG line " << lineNumber << " declares a node without a name." << endl;
+			error = true;
+			eof = true;
+			return false;
+		}
+		curr.name.assign(tok);
+
+		tok = strlen(label) > 7 ? strtok(label + 7, seps) : NULL;
+		if (tok == NULL)			curr.type = 0;
+		else if (strcmp(tok, "ADD") == 0)	curr.type = 0;
+		else if (strcmp(tok, "MUL") == 0)	curr.type = 1;
+		else if (strcmp(tok, "DIV") == 0)	curr.type = 2;
+		else if (strcmp(tok, "SQRT") == 0)	curr.type = 3;
+		else
+			curr.type = 0;
+
+		if (curr.type >= static_cast<int>(res_constr.size()))
+			curr.type = 0;
+
+		curr.pending = 0;
+		curr.readyCC = 1;
+		curr.schl = 0;
+		curr.height = delay[curr.type];
+		curr.sealed = false;
+
+		int id = base + span();
+		nameToId[curr.name] = id;
+		nodes.push_back(std::move(curr));
+
+		stats.opn++;
+		if (span() > stats.peak_resident)
+			stats.peak_resident = span();
+	}
+	else if ((label = strstr(line, "->")) != NULL)	//an edge, it must enter the last declared node
+	{
+		string name, cname;
+		*label = '\0';		//the source node name ends at "->"
+		char* tok = strtok(line, seps);
+		char* ctok = strtok(label + 2, seps);
+		if (tok == NULL || ctok == NULL) {
+			std::cerr << "Error: DFG line " << lineNumber << " is not a complete edge (<source> -> <target>)." << endl;
+			error = true;
+			eof = true;
+			return false;
+		}
+		name.assign(tok);
+		cname.assign(ctok);
+
+		if (span() == 0 || nodes.back().sealed || nodes.back().name != cname) {
+			std::cerr << "Error: edge " << name << " -> " << cname << " is not in streaming order "
+				<< "(edges must follow the node they enter)." << endl;
+			error = true;
+			eof = true;
+			return false;
+		}
+
+		int id = base + span() - 1;
+		auto it = nameToId.find(name);
+
+		// A parent that is not resident anymore finished before the current cc: nothing to wait for
+		if (it != nameToId.end()) {
+			StreamNode& parent = node(it->second);
+
+			if (parent.schl > 0)
+				node(id).readyCC = std::max(node(id).readyCC, parent.schl + delay[parent.type]);
+			else {
+				parent.child.push_back(id);
+				node(id).pending++;
+			}
+		}
+
+		stats.edges++;
+	}
+
+	return true;
+}
+
+// Read the DFG until target_span nodes are resident (or the file ends)
+void StreamScheduler::readNodes(int target_span)
+{
+	while (!eof && span() < target_span)
+		readLine();
+}
+
+// All the parents of the node are known
+void StreamScheduler::seal(int id)
+{
+	node(id).sealed = true;
+	if (node(id).pending == 0)
+		waiting.push(make_pair(node(id).readyCC, id));
+}
+
+// Heights over the resident window (IDs are in topological order), then rebuild the ready heaps
+void StreamScheduler::computeHeights()
+{
+	for (int i = span() - 1; i >= 0; i--) {
+		StreamNode& n = nodes[i];
+		int maxChild = 0;
+		for (int c : n.child)
+			maxChild = std::max(maxChild, node(c).height);
+		n.height = delay[n.type] + maxChild;
+	}
+
+	auto cmp = [this](int a, int b) { return lowerPriority(a, b); };
+	for (auto& heap : ready)
+		std::make_heap(heap.begin(), heap.end(), cmp);
+}
+
+// Nodes whose parents have all finished become ready in the current cc
+void StreamScheduler::releaseWaiting()
+{
+	auto cmp = [this](int a, int b) { return lowerPriority(a, b); };
+
+	while (!waiting.empty() && waiting.top().first <= currentClockCycle) {
+		int id = waiting.top().second;
+		waiting.pop();
+
+		auto& heap = ready[node(id).type];
+		heap.push_back(id);
+		std::push_heap(heap.begin(), heap.end(), cmp);
+	}
+}
+
+// Schedule the ready nodes of every Function type on the free FUs, highest priority first
+void StreamScheduler::scheduleCycle()
+{
+	auto cmp = [this](int a, int b) { return lowerPriority(a, b); };
+
+	for (int t = 0; t < static_cast<int>(ready.size()); t++) {
+		auto& heap = ready[t];
+
+		for (int k = 0; k < static_cast<int>(busy[t].size()) && !heap.empty(); k++) {
+			if (busy[t][k] >= currentClockCycle)
+				continue;
+
+			std::pop_heap(heap.begin(), heap.end(), cmp);
+			int id = heap.back();
+			heap.pop_back();
+
+			StreamNode& n = node(id);
+			n.schl = currentClockCycle;
+			busy[t][k] = currentClockCycle + delay[t] - 1;
+			scheduledInWindow++;
+
+			for (int c : n.child) {
+				StreamNode& su = node(c);
+				su.pending--;
+				su.readyCC = std::max(su.readyCC, currentClockCycle + delay[t]);
+				if (su.pending == 0 && su.sealed)
+					waiting.push(make_pair(su.readyCC, c));
+			}
+			n.child.clear();
+			n.child.shrink_to_fit();
+
+			if (stats.latency < busy[t][k])
+				stats.latency = busy[t][k];
+			if (stats.fus_used[t] < k + 1)
+				stats.fus_used[t] = k + 1;
+
+			// Format: "<oper-ID> <schl-time> <FU-binding ID>"
+			ops_out << id << " " << currentClockCycle << " " << fuOffset[t] + k << "\n";
+
+			if (debug)
+				cout << " => [ASSIGNED] Cycle " << currentClockCycle << ": OpID " << id << " (Type " << t << ") -> Bound to Unit #" << k << endl;
+		}
+	}
+}
+
+// Drop the oldest nodes once they are scheduled and finished: later successors cannot start before the current cc anyway
+void StreamScheduler::evictFinished()
+{
+	while (!nodes.empty()) {
+		StreamNode& n = nodes.front();
+		if (n.schl == 0 || n.schl + delay[n.type] - 1 >= currentClockCycle)
+			break;
+
+		// Keep the node whose parent list is still being read
+		if (!n.sealed)
+			break;
+
+		nameToId.erase(n.name);
+		nodes.pop_front();
+		base++;
+		scheduledInWindow--;
+	}
+}
+
+bool StreamScheduler::run(FILE* input, StreamStats& result)
+{
+	bench = input;
+
+	readNodes(window);
+	computeHeights();
+
+	while (!error) {
+		// Refill the window once half of it has been retired
+		if (!eof && span() <= window / 2) {
+			readNodes(window);
+			computeHeights();
+		}
+
+		releaseWaiting();
+
+		bool nothingReady = true;
+		for (const auto& heap : ready)
+			nothingReady = nothingReady && heap.empty();
+
+		if (nothingReady && waiting.empty()) {
+			if (eof && scheduledInWindow == span())
+				break;	// Everything is scheduled
+
+			bool inFlight = false;
+			for (const auto& fus : busy)
+				for (int f : fus)
+					inFlight = inFlight || (f >= currentClockCycle);
+
+			if (!inFlight) {
+				if (eof) {
+					std::cerr << "Error: streaming scheduler is stuck at cc " << currentClockCycle
+						<< " (is the DFG acyclic and in streaming order?)" << endl;
+					return false;
+				}
+
+				// The resident nodes wait for parents that are not read yet: grow the window
+				if (span() >= STREAM_MAX_GROWTH * window) {
+					std::cerr << "Error: the resident nodes wait for parents that are not read yet, and the window is already "
+						<< STREAM_MAX_GROWTH << " x --window (" << span() << " nodes). Use a larger --window." << endl;
+					return false;
+				}
+				readNodes(span() + 1);
+				computeHeights();
+				continue;
+			}
+		}
+
+		scheduleCycle();
+
+		currentClockCycle++;
+
+		evictFinished();
+	}
+
+	if (error)
+		return false;
+
+	result = stats;
+	return true;
+}
+
+
+bool StreamLS(const string& dfg_file, const string& dfg_name, const string& result_file, std::vector<int>& delay,
+	std::vector<int>& res_constr, std::vector<string>& res_type, int window, StreamStats& stats, bool debug)
+{
+	FILE* bench = fopen(dfg_file.c_str(), "r");
+	if (!bench) {
+		std::cerr << "Error: Reading input DFG file " << dfg_file << " failed." << endl;
+		return false;
+	}
+
+	// Schedule lines are streamed to a temporary file, the header needs the final latency and FU usage
+	string ops_file = result_file + ".ops";
+	ofstream ops_out(ops_file, ios::out);
+	if (!ops_out.is_open()) {
+		std::cerr << "Error: cannot write " << ops_file << endl;
+		fclose(bench);
+		return false;
+	}
+
+	StreamScheduler scheduler(delay, res_constr, std::max(window, 2), ops_out, debug);
+	bool ok = scheduler.run(bench, stats);
+
+	fclose(bench);
+	ops_out.close();
+
+	if (!ok) {
+		remove(ops_file.c_str());
+		return false;
+	}
+
+	ofstream output_sb_result(result_file, ios::out);
+
+	// Comment: DFG name
+	output_sb_result << "// The next line is the dfg name" << endl;
+	output_sb_result << dfg_name << endl;
+
+	// Comment: FU parameters description
+	output_sb_result << "// The next lines are FU parameters given as:" << endl;
+	output_sb_result << "// <FU type>  <resource constraint>  <# of FUs used>  <FU delay>" << endl;
+
+	for (size_t t = 0; t < delay.size(); ++t) {
+		std::string typeName = res_type[t];
+		std::transform(typeName.begin(), typeName.end(), typeName.begin(), ::toupper);
+		output_sb_result << typeName << " " << res_constr[t] << " " << stats.fus_used[t] << " " << delay[t] << endl;
+	}
+
+	// Line after FU params: actual latency
+	output_sb_result << "actual latency " << stats.latency << endl;
+
+	ifstream ops_in(ops_file, ios::in);
+	output_sb_result << ops_in.rdbuf();
+	ops_in.close();
+	output_sb_result.close();
+
+	remove(ops_file.c_str());
+
+	return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+// Small worker-pool helpers shared by the scheduler and the checker.
+// Only the standard library is used so the same header builds on macOS, Linux and WSL.
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Number of workers to use when the user does not ask for a specific value.
+inline int default_thread_count()
+{
+	unsigned int hw = std::thread::hardware_concurrency();
+	return hw > 0 ? static_cast<int>(hw) : 1;
+}
+
+// Run job(i) for every i in [0, count) on up to num_threads workers.
+// Indices are handed out through a shared atomic counter, so jobs finish in no particular order:
+// callers that need a deterministic result store one result per index and reduce them afterwards.
+inline void parallel_for(int count, int num_threads, const std::function<void(int)>& job)
+{
+	if (count <= 0)
+		return;
+
+	if (num_threads <= 0)
+		num_threads = default_thread_count();
+	num_threads = std::min(num_threads, count);
+
+	// Nothing to gain from spawning a thread for a single worker
+	if (num_threads == 1) {
+		for (int i = 0; i < count; i++)
+			job(i);
+		return;
+	}
+
+	std::atomic<int> next(0);
+	auto worker = [&]() {
+		for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+			job(i);
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(num_threads - 1);
+	for (int t = 0; t < num_threads - 1; t++)
+		workers.emplace_back(worker);
+
+	// The calling thread works too
+	worker();
+
+	for (auto& w : workers)
+		w.join();
+}
@@ -0,0 +1,145 @@
+#include "Trace.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+std::atomic<bool> trace_on(false);
+
+struct TraceEvent
+{
+	const char* name;
+	const char* category;
+	double ts_us;		//start, from trace_start()
+	double dur_us;
+	string args;
+};
+
+struct TraceBuffer
+{
+	int tid;
+	vector<TraceEvent> events;
+};
+
+// The buffers are owned here and not by the threads, so the events of finished workers are kept
+static std::mutex registry_mutex;
+static vector<unique_ptr<TraceBuffer>> registry;
+static std::chrono::steady_clock::time_point trace_epoch;
+
+static thread_local TraceBuffer* local_buffer = nullptr;
+
+// Buffer of the calling thread, registered on its first event (the only locked step)
+static TraceBuffer& thread_buffer()
+{
+	if (local_buffer == nullptr) {
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		registry.push_back(unique_ptr<TraceBuffer>(new TraceBuffer()));
+		local_buffer = registry.back().get();
+		local_buffer->tid = registry.size() - 1;
+	}
+
+	return *local_buffer;
+}
+
+static string json_escape(const string& s)
+{
+	string out;
+	for (char c : s) {
+		if (c == '"' || c == '\\')
+			out += '\\';
+		if (static_cast<unsigned char>(c) < 0x20)
+			continue;
+		out += c;
+	}
+	return out;
+}
+
+void trace_start()
+{
+	trace_epoch = std::chrono::steady_clock::now();
+	thread_buffer();	//the calling thread is "main" (tid 0)
+	trace_on.store(true);
+}
+
+void TraceScope::arg(const char* key, long long value)
+{
+	if (!active)
+		return;
+
+	if (!args.empty())
+		args += ",";
+	args += "\"" + string(key) + "\":" + to_string(value);
+}
+
+void TraceScope::arg(const char* key, const std::string& value)
+{
+	if (!active)
+		return;
+
+	if (!args.empty())
+		args += ",";
+	args += "\"" + string(key) + "\":\"" + json_escape(value) + "\"";
+}
+
+void TraceScope::finish()
+{
+	auto end = std::chrono::steady_clock::now();
+
+	TraceEvent event;
+	event.name = name;
+	event.category = category;
+	event.ts_us = std::chrono::duration<double, std::micro>(start - trace_epoch).count();
+	event.dur_us = std::chrono::duration<double, std::micro>(end - start).count();
+	event.args = std::move(args);
+
+	thread_buffer().events.push_back(std::move(event));
+}
+
+bool trace_write(const std::string& filename)
+{
+	trace_on.store(false);
+
+	ofstream fout(filename, ios::out);
+	if (!fout.is_open()) {
+		cerr << "Error: cannot write trace file " << filename << endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(registry_mutex);
+
+	size_t total = 0;
+	fout << std::fixed << std::setprecision(3);
+	fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	bool first = true;
+	for (const auto& buffer : registry) {
+		if (!first)
+			fout << ",\n";
+		first = false;
+
+		fout << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+			<< ",\"args\":{\"name\":\"" << (buffer->tid == 0 ? string("main") : "worker " + to_string(buffer->tid)) << "\"}}";
+
+		for (const auto& e : buffer->events) {
+			fout << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+				<< ",\"ts\":" << e.ts_us << ",\"dur\":" << e.dur_us;
+			if (!e.args.empty())
+				fout << ",\"args\":{" << e.args << "}";
+			fout << "}";
+		}
+
+		total += buffer->events.size();
+	}
+
+	fout << "\n]}\n";
+	fout.close();
+
+	cout << "Trace with " << total << " events written to " << filename << endl;
+	return true;
+}
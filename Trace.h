@@ -0,0 +1,64 @@
+#pragma once
+
+// Optional timeline of a run in the Chrome trace-event format (open the file in chrome://tracing or
+// https://ui.perfetto.dev). Recording is off until trace_start() is called (--trace=<file>); while it is
+// off a TRACE_SCOPE costs one relaxed atomic load.
+//
+// Every thread appends to its own buffer, so worker threads never wait on each other. The buffers are
+// merged by trace_write(), which must be called once the worker threads are done.
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+extern std::atomic<bool> trace_on;
+
+void trace_start();
+bool trace_write(const std::string& filename);
+
+// Records one complete event ("ph":"X") covering the lifetime of the object.
+// name and category must be string literals (they are stored as pointers).
+class TraceScope
+{
+public:
+	TraceScope(const char* name, const char* category)
+		: active(trace_on.load(std::memory_order_relaxed)), name(name), category(category)
+	{
+		if (active)
+			start = std::chrono::steady_clock::now();
+	}
+
+	~TraceScope()
+	{
+		if (active)
+			finish();
+	}
+
+	// Ends the event before the end of the scope
+	void end()
+	{
+		if (active)
+			finish();
+		active = false;
+	}
+
+	// Arguments shown with the event
+	void arg(const char* key, long long value);
+	void arg(const char* key, const std::string& value);
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	void finish();
+
+	bool active;
+	const char* name;
+	const char* category;
+	std::chrono::steady_clock::time_point start;
+	std::string args;		//JSON members, without the braces
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name, category)
@@ -0,0 +1,193 @@
+#include "Verify.h"
+#include "Trace.h"
+#include "Perf.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+
+// Start (+1) or end (-1) of an op's occupancy of a resource: an FU or a function type (key)
+struct SweepEvent {
+	int key;
+	int cc;
+	int delta;
+};
+
+// Sort the events by (key, cc) and report every maximal [from, to) cc range of a key
+// together with the number of ops active on it.
+template <typename F>
+void sweep_intervals(std::vector<SweepEvent>& events, F on_segment)
+{
+	std::sort(events.begin(), events.end(), [](const SweepEvent& a, const SweepEvent& b) {
+		return (a.key != b.key) ? (a.key < b.key) : (a.cc < b.cc);
+	});
+
+	size_t i = 0;
+	while (i < events.size()) {
+		int key = events[i].key;
+		int active = 0;
+
+		while (i < events.size() && events[i].key == key) {
+			int cc = events[i].cc;
+
+			// apply all the events of this cc before looking at the next range
+			while (i < events.size() && events[i].key == key && events[i].cc == cc)
+				active += events[i++].delta;
+
+			if (i < events.size() && events[i].key == key && active > 0)
+				on_segment(key, cc, events[i].cc, active);
+		}
+	}
+}
+
+
+int verify_schedule(const std::vector<int>& op_type, const std::vector<std::pair<int, int>>& edges,
+	const std::vector<int>& start, const std::vector<int>& fu, const std::vector<int>& delay,
+	const std::map<int, std::string>& FU_type, const std::map<int, int>& rc, const std::map<int, int>& reported_FUs,
+	int reported_latency, bool verbose, VerifyReport& report)
+{
+	TRACE_SCOPE("verify_schedule", "check");
+	PERF_SCOPE(PERF_VERIFY);
+
+	int opn = static_cast<int>(op_type.size());
+
+	// Finish cc of each operation, types without a delay count as 0 (as a missing FU line did in the checker)
+	std::vector<int> finish(opn);
+
+	int actual_latency = 0;
+
+	for (auto u = 0; u < opn; u++) {
+		int u_delay = (op_type[u] >= 0 && op_type[u] < static_cast<int>(delay.size())) ? delay[op_type[u]] : 0;
+		finish[u] = start[u] + u_delay - 1;
+
+		// New Change for ML-RCS: get actual latency.
+		if (actual_latency < finish[u])
+			actual_latency = finish[u];
+	}
+
+	//check dependencies: every edge (pr -> su) once, su must start after pr finishes.
+	//a violated edge is recorded under its smaller endpoint ID, as the former parent/child scan did.
+	std::vector<char> error_pair(opn, 0);
+	int dependency_error = 0;
+
+	for (const auto& e : edges) {
+		int pr = e.first, su = e.second;
+
+		if (start[su] > finish[pr])
+			continue;
+
+		int key = std::min(pr, su);
+		if (!error_pair[key]) {
+			error_pair[key] = 1;
+			dependency_error++;
+		}
+	}
+
+	if (verbose) {
+		std::cout << "LC = " << reported_latency << endl;
+		std::cout << "# of dependency error = " << dependency_error << endl;
+	}
+
+	//check FU-overlapping: sweep the start/end events of the ops bound to each FU,
+	//every cc covered by more than one op on the same FU is one error.
+	std::vector<SweepEvent> fu_events;
+	fu_events.reserve(2 * opn);
+	for (auto u = 0; u < opn; u++) {
+		fu_events.push_back({ fu[u], start[u], +1 });
+		fu_events.push_back({ fu[u], finish[u] + 1, -1 });
+	}
+
+	int fu_overlapped_error = 0;
+	sweep_intervals(fu_events, [&](int fu_id, int from, int to, int active) {
+		if (active <= 1)
+			return;
+		for (auto cc = from; cc < to; cc++) {
+			if (verbose)
+				std::cout << "for FU " << fu_id << " cc " << cc << " has 2 op executed on it, error exists." << endl;
+			fu_overlapped_error++;
+		}
+	});
+
+	if (verbose)
+		std::cout << "# of FU usage error (mutliple ops executes on the same cc and same FU) = " << fu_overlapped_error << endl;
+
+	/*
+		New Change for ML-RCS:
+		Check resource constraint:
+	*/
+	//initialize max_resouce usage for each type.
+	std::map<int, int>& max_resource = report.max_usage;
+	max_resource.clear();
+
+	for (const auto& pair : FU_type) {
+		max_resource[pair.first] = 0;
+	}
+
+	//peak # of ops of each type running in the same cc, from the same sweep over types
+	std::vector<SweepEvent> type_events;
+	type_events.reserve(2 * opn);
+	for (auto u = 0; u < opn; u++) {
+		type_events.push_back({ op_type[u], start[u], +1 });
+		type_events.push_back({ op_type[u], finish[u] + 1, -1 });
+	}
+
+	sweep_intervals(type_events, [&](int type, int, int, int active) {
+		if (max_resource[type] < active)
+			max_resource[type] = active;
+	});
+
+	// Total errors found during resource check
+	int total_fu_errors = 0;
+
+	// Iterate over ALL Functional Unit types read from the input file (e.g., ADD, MUL, DIV, SQRT)
+	for (const auto& pair : FU_type) {
+		int type_id = pair.first;
+		const std::string& type_name = pair.second;
+
+		// Safely retrieve usage, reported usage, and constraint
+		int derived_usage = max_resource.count(type_id) ? max_resource.at(type_id) : 0;
+		int reported_usage = reported_FUs.count(type_id) ? reported_FUs.at(type_id) : 0;
+		int constraint = rc.count(type_id) ? rc.at(type_id) : 0;
+
+		// REPORT USAGE AND CONSTRAINT for the current FU type
+		if (verbose)
+			std::cout << "# of " << type_name << " used (derived from your schl solution) = " << derived_usage
+				<< " , reported # of " << type_name << " used = " << reported_usage
+				<< " , " << type_name << " resource constraint = " << constraint << endl;
+
+		// CHECK: Resource Constraint Violation
+		if (derived_usage > constraint) {
+			total_fu_errors++;
+			if (verbose)
+				std::cout << "Resource constraint for " << type_name << " is not satisfied. RC = " << constraint << " Max usage = " << derived_usage << endl;
+		}
+
+		// CHECK: Reported Usage Mismatch (Scheduler reported one value, Checker calculated another)
+		if (reported_usage != derived_usage) {
+			total_fu_errors++;
+			if (verbose)
+				std::cout << "Actual and reported " << type_name << " used are not the same." << endl;
+		}
+	}
+
+	int latency_error = 0;
+
+	if (verbose)
+		std::cout << "Actual Latency = " << actual_latency << " Reported latency = " << reported_latency << endl;
+	if (actual_latency != reported_latency) {
+		latency_error++;
+		if (verbose)
+			std::cout << "Actual latency and reported latency are not the same. " << endl;
+	}
+
+	report.dependency_errors = dependency_error;
+	report.fu_overlap_errors = fu_overlapped_error;
+	report.resource_errors = total_fu_errors;
+	report.latency_errors = latency_error;
+	report.total_errors = dependency_error + fu_overlapped_error + total_fu_errors + latency_error;
+	report.actual_latency = actual_latency;
+
+	return report.total_errors;
+}
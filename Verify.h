@@ -0,0 +1,49 @@
+#pragma once
+
+// In-memory S&B solution verification shared by the scheduler (--verify) and the checker.
+// The checks are the ones the checker has always reported: dependencies, FU overlapping,
+// resource constraints / reported FU usage, and reported latency.
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct VerifyReport
+{
+	int dependency_errors = 0;	//# of dependency errors (violated edges, counted by smaller endpoint ID)
+	int fu_overlap_errors = 0;	//# of (FU, cc) pairs with more than one op executing
+	int resource_errors = 0;	//# of resource constraint violations + reported/derived FU usage mismatches
+	int latency_errors = 0;		//1 if the reported latency is not the actual one
+	int total_errors = 0;
+	int actual_latency = 0;		//latency derived from the schedule
+	std::map<int, int> max_usage;	//<FU type, max # of ops of that type running in the same cc>
+};
+
+// Verify one S&B solution.
+//   op_type[u], start[u], fu[u]: function type, scheduled cc and global FU-ID of operation u
+//   edges: (predecessor, successor) pairs
+//   delay[type]: FU delay of each function type
+//   FU_type / rc / reported_FUs: <FU type, name>, <FU type, resource constraint>, <FU type, reported # of FUs used>
+//   reported_latency: latency reported by the scheduler
+// When verbose is set, the checker report is printed to stdout.
+// Returns the total # of errors (also stored in report).
+int verify_schedule(const std::vector<int>& op_type, const std::vector<std::pair<int, int>>& edges,
+	const std::vector<int>& start, const std::vector<int>& fu, const std::vector<int>& delay,
+	const std::map<int, std::string>& FU_type, const std::map<int, int>& rc, const std::map<int, int>& reported_FUs,
+	int reported_latency, bool verbose, VerifyReport& report);
+
+// Flatten a parsed DFG (std::map<int, G_Node> of the scheduler or of the checker) into op types and an edge list.
+template <typename NodeMap>
+void flatten_graph(const NodeMap& ops, int opn, std::vector<int>& op_type, std::vector<std::pair<int, int>>& edges)
+{
+	op_type.assign(opn, 0);
+	edges.clear();
+
+	for (int u = 0; u < opn; u++) {
+		const auto& node = ops.at(u);
+		op_type[u] = node.type;
+		for (auto su = node.child.begin(); su != node.child.end(); su++)
+			edges.push_back(std::make_pair(u, (*su)->id));
+	}
+}
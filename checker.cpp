@@ -5,6 +5,14 @@
 #include <bitset>
 #include <queue>
 #include <regex>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+
+#include "ThreadPool.h"
+#include "Verify.h"
+#include "Trace.h"
+#include "Perf.h"
 
 using namespace std;
 
@@ -182,277 +190,346 @@ void func4(const std::string& line, S& s) {
 }
 
 
-int main(int argc, char** argv)
+// Per-file outcome of a checker run (one row of the batch verdict file)
+struct CheckVerdict {
+	std::string result_file;
+	std::string dfg_file;
+	int dependency_errors = 0;
+	int fu_overlap_errors = 0;
+	int resource_errors = 0;
+	int latency_errors = 0;
+	int total_errors = 0;
+	int actual_latency = 0;
+	int reported_latency = 0;
+	std::string status;		//PASS, FAIL or ERROR (result or DFG file could not be read)
+};
+
+// Parsed DFG shared by every result file that refers to it
+struct CachedDFG {
+	std::map<int, G_Node> ops;
+	int opn = 0;
+	bool ok = false;
+};
+
+// Derive the DFG file checked against from the name of a result file,
+// e.g. "Results/1.00/Results_LS_hal_4type_uniform_S1_P1.txt" -> "DFG//hal_4type_uniform.txt"
+std::string get_dfg_filename(const std::string& full_path, bool debug)
 {
-	if (argc < 2) {
-		std::cerr << "Usage: fds.exe <input_filename>\n";
-		return 1;
-	}
+	std::string temp_dfg_name;
 
-	int edge_num = 0;
-	int all_error = 0;
-	ops.clear();
-
-	std::string input_filename = argv[1];
-	//std::cout << "Input file: " << input_filename << endl;
-
-	// CHANGED BY SILVIA
+	// Strip directories by removing everything up to the last slash
+	size_t last_slash = full_path.find_last_of("/\\");
+	if (last_slash != std::string::npos) {
+		temp_dfg_name = full_path.substr(last_slash + 1);
+	} else {
+		temp_dfg_name = full_path;
+	}
 
-    // Get the full path passed by Python
-    std::string full_path = input_filename;
-    std::string temp_dfg_name;
-	bool debug = argv[2] == std::string("1");
+	// Strip extension
+	size_t last_dot = temp_dfg_name.find_last_of(".");
+	if (last_dot != std::string::npos) {
+		temp_dfg_name = temp_dfg_name.substr(0, last_dot);
+	}
 
-	cout << "Checker debug mode: " << (debug ? "ON" : "OFF") << endl;
+	// Strip features: Remove suffixes like _S1_P1 using Regex
+	temp_dfg_name = std::regex_replace(temp_dfg_name, std::regex("(_S[0-9]+_P[0-9]+)"), "");
 
-    // Strip directories by removing everything up to the last slash
-    size_t last_slash = full_path.find_last_of("/\\");
-    if (last_slash != std::string::npos) {
-        temp_dfg_name = full_path.substr(last_slash + 1);
-    } else {
-        temp_dfg_name = full_path;
-    }
-    
-    // Strip extension
-    size_t last_dot = temp_dfg_name.find_last_of(".");
-    if (last_dot != std::string::npos) {
-        temp_dfg_name = temp_dfg_name.substr(0, last_dot);
-    }
+	// Strip prefixes: Remove "Results_LS_", "Results_FDS_", "Results_Portfolio_", "Results_BB_" or "Results_MultiStart_" (scheduler engines)
+	// Output: "invdelay"
+	for (const std::string prefix : { "Results_LS_", "Results_FDS_", "Results_Portfolio_", "Results_BB_", "Results_MultiStart_" })
+		if (temp_dfg_name.find(prefix) == 0) {
+			temp_dfg_name = temp_dfg_name.substr(prefix.length());
+			break;
+		}
 
-    // Strip features: Remove suffixes like _S1_P1 using Regex
-    temp_dfg_name = std::regex_replace(temp_dfg_name, std::regex("(_S[0-9]+_P[0-9]+)"), "");
+	if (debug)
+		std::cout << "[DEBUG] Extracted DFG Name: " << temp_dfg_name << endl;
 
-    // Strip prefixes: Remove "Results_LS_" or "LS_"
-    // Output: "invdelay"
-    std::string prefix1 = "Results_LS_";
+	// Construct the actual DFG file path
+	return "DFG//" + temp_dfg_name + ".txt";
+}
 
-    if (temp_dfg_name.find(prefix1) == 0) { 
-        temp_dfg_name = temp_dfg_name.substr(prefix1.length());
-    }
+// Run the dependency, FU-overlap, resource-constraint and latency checks of one S&B solution.
+// ops is only read, so the same parsed DFG can be checked by several threads at once.
+// When verbose is set, the usual per-check report is printed to stdout.
+void validate_schedule(const std::map<int, G_Node>& ops, int opn, S& sb_res, std::map<int, string>& FU_type,
+	std::map<int, int>& delay, std::map<int, int>& reported_FUs, std::map<int, int>& rc, int reported_latency,
+	bool verbose, CheckVerdict& verdict)
+{
+	std::vector<int> op_type, start(opn), fu(opn), delay_by_type;
+	std::vector<std::pair<int, int>> edges;
 
-    if (debug)
-        std::cout << "[DEBUG] Extracted DFG Name: " << temp_dfg_name << endl;
+	flatten_graph(ops, opn, op_type, edges);
 
-    // Construct the actual DFG file path
-    string filename;
-    filename = "DFG//" + temp_dfg_name + ".txt";
+	// Missing entries default to 0, as the map lookups always did
+	for (auto u = 0; u < opn; u++) {
+		start[u] = sb_res.schedule[u];
+		fu[u] = sb_res.bind[u];
+	}
 
+	int max_type = 0;
+	for (auto u = 0; u < opn; u++)
+		max_type = std::max(max_type, op_type[u]);
+	if (!delay.empty())
+		max_type = std::max(max_type, delay.rbegin()->first);
+
+	delay_by_type.assign(max_type + 1, 0);
+	for (const auto& pair : delay)
+		if (pair.first >= 0)
+			delay_by_type[pair.first] = pair.second;
+
+	VerifyReport report;
+	verify_schedule(op_type, edges, start, fu, delay_by_type, FU_type, rc, reported_FUs, reported_latency, verbose, report);
+
+	verdict.dependency_errors = report.dependency_errors;
+	verdict.fu_overlap_errors = report.fu_overlap_errors;
+	verdict.resource_errors = report.resource_errors;
+	verdict.latency_errors = report.latency_errors;
+	verdict.total_errors = report.total_errors;
+	verdict.actual_latency = report.actual_latency;
+	verdict.reported_latency = reported_latency;
+	verdict.status = (verdict.total_errors == 0) ? "PASS" : "FAIL";
+}
 
-    if (debug)
-        std::cout << "Reading DFG file: " << filename << endl;
 
-    readGraphInfo(filename, edge_num, opn, ops);
+// Collect the result files to check: directories are scanned recursively for ".txt" files.
+void collect_result_files(const std::vector<std::string>& inputs, std::vector<std::string>& files)
+{
+	for (const auto& input : inputs) {
+		std::error_code ec;
+		if (std::filesystem::is_directory(input, ec)) {
+			for (const auto& entry : std::filesystem::recursive_directory_iterator(input, ec))
+				if (entry.is_regular_file() && entry.path().extension() == ".txt")
+					files.push_back(entry.path().string());
+		}
+		else {
+			files.push_back(input);
+		}
+	}
 
+	// Stable verdict order whatever the directory iteration order is
+	std::sort(files.begin(), files.end());
+	files.erase(std::unique(files.begin(), files.end()), files.end());
+}
 
+// Check every result file in one process: each DFG is parsed once, files are validated by a worker pool
+// and one verdict row per file is written to verdict_file as CSV.
+int run_batch(const std::vector<std::string>& inputs, int jobs, const std::string& verdict_file, bool debug)
+{
+	std::vector<std::string> files;
+	collect_result_files(inputs, files);
 
-	// END CHANGED BY SILVIA
+	if (files.empty()) {
+		std::cerr << "Error: no result files found." << std::endl;
+		return 1;
+	}
 
+	std::map<std::string, std::unique_ptr<CachedDFG>> dfg_cache;
+	std::mutex dfg_cache_mutex;
 
-	std::string DFG_name;
-	std::map<int, string> FU_type;
-	FU_type.clear();
+	// Parse a DFG the first time it is referenced. readGraphInfo() relies on strtok(), so parsing stays serialized.
+	auto get_dfg = [&](const std::string& dfg_filename) -> const CachedDFG* {
+		std::lock_guard<std::mutex> lock(dfg_cache_mutex);
 
-	std::map<string, int> FU_type_name_to_id;
-	FU_type_name_to_id.clear();
+		auto it = dfg_cache.find(dfg_filename);
+		if (it != dfg_cache.end())
+			return it->second.get();
 
-	//read s&b results:
-	S sb_res;
-	sb_res.bind.clear();
-	sb_res.fu_info.clear();
-	sb_res.schedule.clear();
+		std::unique_ptr<CachedDFG> entry(new CachedDFG());
 
-	std::map<int, int> delay, reported_FUs, rc;
-	delay.clear();
-	reported_FUs.clear();
-	rc.clear();
+		TraceScope load_trace("load_dfg", "io");
+		load_trace.arg("dfg", dfg_filename);
 
+		// readGraphInfo() terminates the program on a missing file, check it first
+		if (std::ifstream(dfg_filename).good()) {
+			int edge_num = 0;
+			string filename = dfg_filename;
+			readGraphInfo(filename, edge_num, entry->opn, entry->ops);
+			entry->ok = true;
+		}
+		else {
+			std::cerr << "Error: cannot open DFG file " << dfg_filename << std::endl;
+		}
 
-	get_S_structure(input_filename, DFG_name, FU_type, rc, reported_FUs, delay, FU_type_name_to_id,
-		LC, sb_res);
+		const CachedDFG* ptr = entry.get();
+		dfg_cache[dfg_filename] = std::move(entry);
+		return ptr;
+	};
 
-	cout << "reported FUs ADD = " << reported_FUs[0] << " MUL = " << reported_FUs[1] << endl;
-	cout << "delay of ADD = " << delay[0] << " MUL = " << delay[1] << endl;
+	std::vector<CheckVerdict> verdicts(files.size());
+
+	parallel_for(static_cast<int>(files.size()), jobs, [&](int i) {
+		TraceScope file_trace("check_file", "check");
+		file_trace.arg("file", files[i]);
+
+		CheckVerdict& verdict = verdicts[i];
+		verdict.result_file = files[i];
+		verdict.dfg_file = get_dfg_filename(files[i], debug);
+		verdict.status = "ERROR";
+
+		const CachedDFG* dfg = get_dfg(verdict.dfg_file);
+		if (!dfg->ok)
+			return;
+
+		string input_filename = files[i];
+		string DFG_name;
+		std::map<int, string> FU_type;
+		std::map<string, int> FU_type_name_to_id;
+		std::map<int, int> delay, reported_FUs, rc;
+		int reported_latency = 0;
+		S sb_res;
+
+		TraceScope parse_trace("parse_result", "io");
+		if (get_S_structure(input_filename, DFG_name, FU_type, rc, reported_FUs, delay, FU_type_name_to_id,
+			reported_latency, sb_res) != 0)
+			return;
+		parse_trace.end();
+
+		validate_schedule(dfg->ops, dfg->opn, sb_res, FU_type, delay, reported_FUs, rc, reported_latency, debug, verdict);
+	});
+
+	ofstream fout(verdict_file, ios::out);
+	if (!fout.is_open()) {
+		std::cerr << "Error: cannot write verdict file " << verdict_file << std::endl;
+		return 1;
+	}
 
-	int dependency_error = 0;
+	fout << "Result_File,DFG_File,Dependency_Errors,FU_Overlap_Errors,Resource_Errors,Latency_Errors,Total_Errors,Actual_Latency,Reported_Latency,Status\n";
 
-	std::map<int, int> error_pair;
-	error_pair.clear();
+	int passed = 0, failed = 0, errors = 0;
+	for (const auto& v : verdicts) {
+		fout << v.result_file << ","
+			<< v.dfg_file << ","
+			<< v.dependency_errors << ","
+			<< v.fu_overlap_errors << ","
+			<< v.resource_errors << ","
+			<< v.latency_errors << ","
+			<< v.total_errors << ","
+			<< v.actual_latency << ","
+			<< v.reported_latency << ","
+			<< v.status << "\n";
 
-	int actual_latency = 0;
+		if (v.status == "PASS") passed++;
+		else if (v.status == "FAIL") failed++;
+		else errors++;
+	}
+	fout.close();
 
-	for (auto u = 0; u < opn; u++) {
+	std::cout << "Checked " << verdicts.size() << " files (" << dfg_cache.size() << " DFGs): "
+		<< passed << " PASS, " << failed << " FAIL, " << errors << " ERROR" << endl;
+	std::cout << "Verdicts written to " << verdict_file << endl;
 
-		int u_type = ops[u].type;
-		int u_delay = delay[u_type];
-		int u_start_time = sb_res.schedule[u];
-		int u_end_time = u_start_time + u_delay - 1;
+	return (failed + errors > 0) ? 1 : 0;
+}
 
-		// New Change for ML-RCS: get actual latency.
-		if (actual_latency < u_end_time)
-			actual_latency = u_end_time;
 
-		if (ops[u].parent.size() > 0) {
-			for (auto prsu = ops[u].parent.begin(); prsu != ops[u].parent.end(); prsu++) {
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::cerr << "Usage: fds.exe <input_filename> [debug]\n";
+		std::cerr << "       fds.exe --batch [--jobs=N] [--out=verdicts.csv] [--trace=trace.json] [--perf=perf.csv] [--debug] <results dir | result files...>\n";
+		return 1;
+	}
 
-				int prsu_type = (*prsu)->type;
-				int prsu_delay = delay[prsu_type];
-				int prsu_start_time = sb_res.schedule[(*prsu)->id];
-				int prsu_end_time = prsu_start_time + prsu_delay - 1;
+	// Batch mode: validate a whole results directory (or list of files) in one process
+	if (argv[1] == std::string("--batch")) {
+		std::vector<std::string> inputs;
+		int jobs = 0;
+		std::string verdict_file = "checker_verdicts.csv";
+		std::string trace_file;
+		std::string perf_file;
+		bool batch_debug = false;
+
+		for (int i = 2; i < argc; i++) {
+			std::string arg = argv[i];
+			if (arg.rfind("--jobs=", 0) == 0)
+				jobs = std::stoi(arg.substr(7));
+			else if (arg.rfind("--out=", 0) == 0)
+				verdict_file = arg.substr(6);
+			else if (arg.rfind("--trace=", 0) == 0)
+				trace_file = arg.substr(8);
+			else if (arg.rfind("--perf=", 0) == 0)
+				perf_file = arg.substr(7);
+			else if (arg == "--debug")
+				batch_debug = true;
+			else
+				inputs.push_back(arg);
+		}
 
-				if (u_start_time > prsu_end_time) {
+		if (!trace_file.empty())
+			trace_start();
 
-				}
-				else {
-					//cout << "error: u = " << u << " time = " << u_time << " pr = " << (*prsu)->id << " pr_time = " << prsu_time << " pr_delay = " << prsu_delay << endl;
+		if (!perf_file.empty() && !perf_open(perf_file))
+			return 1;
 
-					if (u < (*prsu)->id)
-						error_pair[u] = (*prsu)->id;
-					else
-						error_pair[(*prsu)->id] = u;
-				}
-			}
-		}
+		int status = run_batch(inputs, jobs, verdict_file, batch_debug);
 
-		if (ops[u].child.size() > 0) {
-			for (auto prsu = ops[u].child.begin(); prsu != ops[u].child.end(); prsu++) {
+		if (!trace_file.empty())
+			trace_write(trace_file);
 
-				int prsu_type = (*prsu)->type;
-				int prsu_delay = delay[prsu_type];
-				int prsu_start_time = sb_res.schedule[(*prsu)->id];
-				int prsu_end_time = prsu_start_time + prsu_delay - 1;
+		// one row for the whole batch, summed over the worker threads
+		perf_flush("batch");
+		perf_close();
 
-				if (u_end_time < prsu_start_time) {
+		return status;
+	}
 
-				}
-				else {
+	int edge_num = 0;
+	int all_error = 0;
+	ops.clear();
 
-					//	cout << "error: u = " << u << " time = " << u_time << " su = " << (*prsu)->id << " su_time = " << prsu_time << " u_delay = " << u_delay << endl;
+	std::string input_filename = argv[1];
+	//std::cout << "Input file: " << input_filename << endl;
 
-					if (u < (*prsu)->id)
-						error_pair[u] = (*prsu)->id;
-					else
-						error_pair[(*prsu)->id] = u;
-				}
-			}
-		}
+	// CHANGED BY SILVIA
 
-	}
+	bool debug = (argc >= 3) && argv[2] == std::string("1");
 
-	std::cout << "LC = " << LC << endl;
-	std::cout << "# of dependency error = " << error_pair.size() << endl;
+	cout << "Checker debug mode: " << (debug ? "ON" : "OFF") << endl;
 
-	//check FU-overlapping:
+	string filename = get_dfg_filename(input_filename, debug);
 
-	std::map<int, int> FUs;
-	FUs.clear();
+	if (debug)
+		std::cout << "Reading DFG file: " << filename << endl;
 
-	for (auto u = 0; u < opn; u++)
-		FUs[sb_res.bind[u]] = 1;
+	readGraphInfo(filename, edge_num, opn, ops);
 
-	std::map<int, std::map<int, int>> FU_bind;
-	FU_bind.clear();
 
-	std::map<int, std::map<int, int>> FU_usage;
-	FU_usage.clear();
 
-	for (auto fu = FUs.begin(); fu != FUs.end(); fu++)
-		for (auto cc = 1; cc <= actual_latency; cc++)
-			FU_bind[fu->first][cc] = 0;
+	// END CHANGED BY SILVIA
 
-	for (const auto& pair : FU_type) {
-		int type = pair.first;
-		for (auto cc = 1; cc <= actual_latency; cc++)
-			FU_usage[type][cc] = 0;
-	}
 
-	for (auto u = 0; u < opn; u++)
-	{
-		int my_fu = sb_res.bind[u];
+	std::string DFG_name;
+	std::map<int, string> FU_type;
+	FU_type.clear();
 
-		int my_delay = delay[ops[u].type];
+	std::map<string, int> FU_type_name_to_id;
+	FU_type_name_to_id.clear();
 
-		int my_cc = sb_res.schedule[u];
+	//read s&b results:
+	S sb_res;
+	sb_res.bind.clear();
+	sb_res.fu_info.clear();
+	sb_res.schedule.clear();
 
-		for (auto c = my_cc; c < my_cc + my_delay; c++)
-		{
-			FU_bind[my_fu][c]++;
-			FU_usage[ops[u].type][c]++;
-		}
+	std::map<int, int> delay, reported_FUs, rc;
+	delay.clear();
+	reported_FUs.clear();
+	rc.clear();
 
-	}
 
-	int fu_overlapped_error = 0;
-	for (auto fu = FU_bind.begin(); fu != FU_bind.end(); fu++)
-		for (auto cc = fu->second.begin(); cc != fu->second.end(); cc++)
-			if (cc->second > 1) {
-				std::cout << "for FU " << fu->first << " cc " << cc->first << " has 2 op executed on it, error exists." << endl;
-				fu_overlapped_error++;
-			}
+	get_S_structure(input_filename, DFG_name, FU_type, rc, reported_FUs, delay, FU_type_name_to_id,
+		LC, sb_res);
 
-	std::cout << "# of FU usage error (mutliple ops executes on the same cc and same FU) = " << fu_overlapped_error << endl;
+	cout << "reported FUs ADD = " << reported_FUs[0] << " MUL = " << reported_FUs[1] << endl;
+	cout << "delay of ADD = " << delay[0] << " MUL = " << delay[1] << endl;
 
-	/*
-		New Change for ML-RCS:
-		Check resource constraint:
-	*/
-	//initialize max_resouce usage for each type.
-	std::map<int, int> max_resource;
+	CheckVerdict verdict;
+	validate_schedule(ops, opn, sb_res, FU_type, delay, reported_FUs, rc, LC, true, verdict);
 
-	for (const auto& pair : FU_type) { 
-		max_resource[pair.first] = 0; 
-	}
+	std::cout << "********** For DFG : " << DFG << " , Reported LC = " << LC << " , Total # of Errors = " << verdict.total_errors << " * *********************" << endl;
 
-	for (const auto& pair : FU_usage) {
-		int type = pair.first;
-		for (const auto& cc_pair : pair.second) {
-			if (max_resource[type] < cc_pair.second) {
-				max_resource[type] = cc_pair.second;
-			}
-		}
-	}
-	// Total errors found during resource check
-    int total_fu_errors = 0; 
-
-    // Iterate over ALL Functional Unit types read from the input file (e.g., ADD, MUL, DIV, SQRT)
-    for (const auto& pair : FU_type) {
-        int type_id = pair.first;
-        const std::string& type_name = pair.second;
-
-        // Safely retrieve usage, reported usage, and constraint
-        int derived_usage = max_resource.count(type_id) ? max_resource.at(type_id) : 0;
-        int reported_usage = reported_FUs.count(type_id) ? reported_FUs.at(type_id) : 0;
-        int constraint = rc.count(type_id) ? rc.at(type_id) : 0;
-
-        // REPORT USAGE AND CONSTRAINT for the current FU type
-        std::cout << "# of " << type_name << " used (derived from your schl solution) = " << derived_usage 
-                  << " , reported # of " << type_name << " used = " << reported_usage 
-                  << " , " << type_name << " resource constraint = " << constraint << endl;
-
-        // CHECK: Resource Constraint Violation
-        if (derived_usage > constraint) {
-            total_fu_errors++; 
-            std::cout << "Resource constraint for " << type_name << " is not satisfied. RC = " << constraint << " Max usage = " << derived_usage << endl;
-        }
-
-        // CHECK: Reported Usage Mismatch (Scheduler reported one value, Checker calculated another)
-        if (reported_usage != derived_usage) {
-            total_fu_errors++; 
-            std::cout << "Actual and reported " << type_name << " used are not the same." << endl;
-        }
-    }
-    
-    // Add errors found in the resource and reporting check to the main error counter
-    fu_overlapped_error += total_fu_errors;
-
-	std::cout << "Actual Latency = " << actual_latency << " Reported latency = " << LC << endl;
-	if (actual_latency != LC) {
-		fu_overlapped_error++; //increment # of total errors.
-		std::cout << "Actual latency and reported latency are not the same. " << endl;
-	}
-
-	std::cout << "********** For DFG : " << DFG << " , Reported LC = " << LC << " , Total # of Errors = " << (fu_overlapped_error + error_pair.size()) << " * *********************" << endl;
-
-	all_error += (fu_overlapped_error + error_pair.size());
+	all_error += verdict.total_errors;
 
 	// CHANGED BY SILVIA
 	// std::cout << "Press ENTER to terminate the program." << endl;
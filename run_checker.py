@@ -3,58 +3,64 @@ import subprocess
 import os
 import sys
 import re
+import tempfile
 
 # IMPLEMENTED BY SILVIA
 
-def get_checker_result(checker_exe, txt_file, debug):
-    
-    DFG_ERROR_PATTERN = r"total # of errors = (\d+)"
+def get_checker_results(checker_exe, txt_files, debug):
 
-    if os.path.exists(txt_file):
-        try:
-            # Run checker executable
+    # Validate all result files with a single checker process (batch mode).
+    # Returns a dict {txt_file: status}; files that do not exist are left out.
 
+    existing_files = [f for f in txt_files if os.path.exists(f)]
 
-            if debug:
-                debug_raw = "1"
-                print(f"Executing: {checker_exe} {txt_file} {debug_raw}")
-            else:
-                debug_raw = "0"
+    if not existing_files:
+        return {}
 
-            # Commands to pass to subprocess
-            cmd_args = [checker_exe, txt_file, debug_raw]
+    # Verdicts are written by the checker as CSV, one row per result file
+    fd, verdict_file = tempfile.mkstemp(suffix=".csv")
+    os.close(fd)
 
-            result = subprocess.run(cmd_args, capture_output=True, text=True, timeout=20)
-            
-            if debug:
-                print(f"Checker stdout: {result.stdout}")
-                print(f"Checker stderr: {result.stderr}")
+    try:
+        # Commands to pass to subprocess
+        cmd_args = [checker_exe, "--batch", f"--out={verdict_file}"] + existing_files
 
-            output = result.stdout.lower() + result.stderr.lower()
-            
-            match = re.search(DFG_ERROR_PATTERN, output.lower())
-        
-            if match:
-                # Capture the number of errors
-                total_errors = int(match.group(1))
-                
-                # Check the extracted value
-                if total_errors == 0:
-
-                    # Success case
-                    return "CHECKER_PASS"
-                else:
-                    # Failure case
-                    return f"CHECKER_FAIL ({total_errors} errors)"
-            else:
-                # If the specific metric line was not found, something structural is wrong 
-                # (e.g., checker crashed before completion, or output format changed)
-                return "CHECKER_FAIL (Output metric not found)"
-
-        except subprocess.TimeoutExpired:
-            return "TIMEOUT" # If the checker hangs for too long
-        except Exception as e:
-            return f"ERROR: {str(e)}"
+        if debug:
+            print(f"Executing: {checker_exe} --batch --out={verdict_file} ({len(existing_files)} files)")
+
+        # Same per-file budget as the former one-process-per-file runs
+        result = subprocess.run(cmd_args, capture_output=True, text=True, timeout=20 * len(existing_files))
+
+        if debug:
+            print(f"Checker stdout: {result.stdout}")
+            print(f"Checker stderr: {result.stderr}")
+
+        verdicts = pd.read_csv(verdict_file)
+
+    except subprocess.TimeoutExpired:
+        return {f: "TIMEOUT" for f in existing_files} # If the checker hangs for too long
+    except Exception as e:
+        return {f: f"ERROR: {str(e)}" for f in existing_files}
+    finally:
+        os.remove(verdict_file)
+
+    results = {}
+
+    for _, row in verdicts.iterrows():
+
+        total_errors = int(row['Total_Errors'])
+
+        if row['Status'] == "ERROR":
+            # Result or DFG file could not be read
+            results[row['Result_File']] = "CHECKER_FAIL (Output metric not found)"
+        elif total_errors == 0:
+            # Success case
+            results[row['Result_File']] = "CHECKER_PASS"
+        else:
+            # Failure case
+            results[row['Result_File']] = f"CHECKER_FAIL ({total_errors} errors)"
+
+    return results
 
 
 def main():
@@ -112,8 +118,8 @@ def main():
         print(f"Reading CSV from: {csv_dir}")
         print(f"Looking for TXT results in: {results_dir}\n")
     
-    # List to store checker results
-    checker_results = []
+    # Result files to check, one per CSV row
+    txt_paths = []
 
     for index, row in df.iterrows():
 
@@ -132,13 +138,18 @@ def main():
             print(f"Checking DFG: {dfg_name}")
             print(f"Target File: {txt_filename}")
 
-        full_txt_path = os.path.join(results_dir, txt_filename)
+        txt_paths.append(os.path.join(results_dir, txt_filename))
 
-        res = get_checker_result(checker_exe, full_txt_path, debug)
-        checker_results.append(res)
-        
-        if debug:   
-            print(f"Checking {dfg_name}: {res}\n")
+    # One checker process for the whole CSV
+    results = get_checker_results(checker_exe, txt_paths, debug)
+
+    # List to store checker results
+    checker_results = [results.get(path) for path in txt_paths]
+
+    if debug:
+        for path, res in zip(txt_paths, checker_results):
+            print(f"Checking {os.path.basename(path)}: {res}")
+        print()
 
     # Add the checker status column to DataFrame
     df['Checker_Status'] = checker_results
@@ -11,6 +11,8 @@ FEAT_P=0
 DATA_TYPE="invdelay"
 LS_BASE=0
 SCALE_FACTOR=1.0
+EXTRA_ARGS=()
+BUILD_FLAGS=()
 
 # Define colors
 RED='\033[0;31m'
@@ -42,6 +44,8 @@ if [ "$MODE" == "-h" ] || [ "$MODE" == "--help" ] || [ -z "$MODE" ]; then
     echo "Modes:"
     echo -e "  ${GREEN}run${NC}                Compile and run the scheduler."
     echo -e "  ${GREEN}check${NC}       Compile and run the checker on the specified file."
+    echo -e "  ${GREEN}gen${NC}                Compile and run the synthetic DFG generator."
+    echo -e "  ${GREEN}bench${NC}              Compile and run the kernel microbenchmarks."
     echo ""
     echo "Options for 'run' mode:"
     echo -e " ${YELLOW}--debug${NC}            Enable debug mode."
@@ -51,10 +55,37 @@ if [ "$MODE" == "-h" ] || [ "$MODE" == "--help" ] || [ -z "$MODE" ]; then
     echo -e " ${YELLOW}--invdelay${NC}         Run with INVERSE DELAY distribution."
     echo -e " ${YELLOW}--base${NC}             Enable base LS mode (standard implementation)."
     echo -e " ${YELLOW}--scaling=[value]${NC}   Set scaling factor for resource constraints (default is 1.0)."
+    echo -e " ${YELLOW}--verify${NC}           Validate every produced schedule in memory (same checks as the checker)."
+    echo -e " ${YELLOW}--stream=[file]${NC}    Schedule one DFG file in streaming order with a bounded memory window."
+    echo -e " ${YELLOW}--window=[N]${NC}       Max # of resident nodes for --stream (default is 4096)."
+    echo -e " ${YELLOW}--dfg=[file]${NC}       Schedule only this DFG file (text or .dfgb)."
+    echo -e " ${YELLOW}--instrument${NC}       Build with per-phase counters and timers (extra CSV columns)."
+    echo -e " ${YELLOW}--alloc-count${NC}      Build with heap allocation counting and peak RSS (extra CSV columns)."
+    echo -e " ${YELLOW}--trace=[file]${NC}     Write a Chrome trace-event timeline of the run (chrome://tracing, Perfetto)."
+    echo -e " ${YELLOW}--perf=[file]${NC}      Write hardware performance counters per DFG and phase (Linux only)."
+    echo -e " ${YELLOW}--repeat=[N]${NC}       Time N scheduling runs per DFG and report min/median/p95/stddev."
+    echo -e " ${YELLOW}--warmup=[W]${NC}       Untimed runs per DFG before the timed ones."
+    echo -e " ${YELLOW}--pin${NC}              Pin the scheduler to one CPU (Linux only)."
+    echo -e " ${YELLOW}--cache[=dir]${NC}      Reuse schedules of identical runs stored in dir (default is Cache)."
+    echo -e " ${YELLOW}--cache-verify${NC}     Check every schedule taken from the cache, reschedule if it fails."
+    echo -e " ${YELLOW}--engine=[e]${NC}       Scheduler: ls (base LS), fdls (default), fds (Force-Directed Scheduling) or bb."
+    echo -e " ${YELLOW}--fds-search=[s]${NC}   FDS latency constraint search: bisect (default) or step."
+    echo -e " ${YELLOW}--fds-threads=[N]${NC}  FDS threads per run; --fds-lookahead=[N], --fds-probes=[N] also apply to FDS."
+    echo -e " ${YELLOW}--bb-time=[ms]${NC}     Time budget of the branch-and-bound search per DFG (default 10000, 0: none)."
+    echo -e " ${YELLOW}--bb-threads=[N]${NC}   Branch-and-bound threads (default: one per core)."
+    echo -e " ${YELLOW}--multistart=[N]${NC}   Run N randomized LS passes in parallel and keep the best (--multistart-seed=[S], --multistart-threads=[N])."
+    echo -e " ${YELLOW}--portfolio[=list]${NC} Run several engines at once and keep the best (list: ls,fdls_S0_P0,...,fds)."
     echo ""
     echo "Options for 'check' mode:"
     echo -e " ${YELLOW}[file]${NC}             Input CSV file to run the checker on and update accordingly."
+    echo -e " ${YELLOW}[dir]${NC}              Results directory to validate in one batch (verdicts in checker_verdicts.csv)."
     echo -e " ${YELLOW}--debug${NC}            Enable debug mode."
+    echo ""
+    echo "Arguments for 'gen' mode:"
+    echo -e " ${YELLOW}<name> <# of nodes> <uniform|invdelay>${NC} [--depth=D] [--fanin=K] [--fanout=F] [--span=L] [--seed=S] [--out=DIR] [--binary] [--constraints=FILE]"
+    echo ""
+    echo "Arguments for 'bench' mode:"
+    echo -e " [--repeats=N] [--warmup=W] [--type=T] [--scale=X] [--kernels=a,b] [--max-fds=N] [--max-outer=N] [--no-builtin] [--out=FILE] [--compare=FILE] [DFG files/dirs]"
     exit 0
 fi
 
@@ -91,6 +122,42 @@ for arg in "${@:2}"; do
             SCALE_FACTOR="${arg#*=}"
             echo -e "${YELLOW}[INFO] Scaling factor set to: ${SCALE_FACTOR}${NC}"
             ;;
+        --verify|-V)
+            EXTRA_ARGS+=(--verify)
+            echo -e "${YELLOW}[INFO] In-memory schedule verification enabled.${NC}"
+            ;;
+        --instrument)
+            BUILD_FLAGS+=(-DLS_INSTRUMENT)
+            echo -e "${YELLOW}[INFO] Per-phase instrumentation enabled.${NC}"
+            ;;
+        --alloc-count)
+            BUILD_FLAGS+=(-DLS_ALLOC_COUNT)
+            echo -e "${YELLOW}[INFO] Allocation counting enabled.${NC}"
+            ;;
+        --trace=*)
+            EXTRA_ARGS+=("$arg")
+            echo -e "${YELLOW}[INFO] Trace written to: ${arg#*=}${NC}"
+            ;;
+        --repeat=*|--warmup=*|--pin)
+            EXTRA_ARGS+=("$arg")
+            echo -e "${YELLOW}[INFO] Runtime measurement option: ${arg}${NC}"
+            ;;
+        --cache|--cache=*|--cache-verify)
+            EXTRA_ARGS+=("$arg")
+            echo -e "${YELLOW}[INFO] Schedule cache option: ${arg}${NC}"
+            ;;
+        --engine=*|--fds-search=*|--fds-threads=*|--fds-lookahead=*|--fds-probes=*|--bb-time=*|--bb-threads=*|--multistart=*|--multistart-seed=*|--multistart-threads=*|--portfolio|--portfolio=*)
+            EXTRA_ARGS+=("$arg")
+            echo -e "${YELLOW}[INFO] Engine option: ${arg}${NC}"
+            ;;
+        --perf=*)
+            EXTRA_ARGS+=("$arg")
+            echo -e "${YELLOW}[INFO] Performance counters written to: ${arg#*=}${NC}"
+            ;;
+        --stream=*|--window=*|--dfg=*)
+            EXTRA_ARGS+=("$arg")
+            echo -e "${YELLOW}[INFO] Streaming option: ${arg}${NC}"
+            ;;
     esac
 done
     
@@ -100,12 +167,12 @@ if [ "$MODE" == "run" ]; then
     # Compile the scheduler
     echo -e "${CYAN}[BUILD] Compiling scheduler...${NC}"
     echo ""
-    g++ -std=c++17 -O3 -I. LSMain.cpp LS.cpp FDS.cpp readInputs.cpp -o scheduler
+    g++ -std=c++17 -O3 -pthread "${BUILD_FLAGS[@]}" -I. LSMain.cpp LS.cpp FDS.cpp ReadInputs.cpp Verify.cpp StreamLS.cpp Trace.cpp Perf.cpp AllocCount.cpp ScheduleCache.cpp Portfolio.cpp LowerBound.cpp BranchBound.cpp MultiStart.cpp -o scheduler
 
     # Run the scheduler
     if [ $? -eq 0 ]; then
         echo -e "${GREEN}[BUILD] Compilation successful. Running scheduler...${NC}"
-        ./scheduler$EXT "$DEBUG" "$FEAT_S" "$FEAT_P" "$DATA_TYPE" "$LS_BASE" "$SCALE_FACTOR"
+        ./scheduler$EXT "$DEBUG" "$FEAT_S" "$FEAT_P" "$DATA_TYPE" "$LS_BASE" "$SCALE_FACTOR" "${EXTRA_ARGS[@]}"
     else
         echo -e "${RED}[ERROR] Compilation failed.${NC}"
         exit 1
@@ -118,7 +185,7 @@ elif [ "$MODE" == "check" ]; then
     # Compile the checker
     echo -e "${CYAN}[BUILD] Compiling checker...${NC}"
     echo ""
-    g++ -std=c++17 -I. checker.cpp -o checker_mac         
+    g++ -std=c++17 -pthread -I. checker.cpp Verify.cpp Trace.cpp Perf.cpp -o checker_mac         
 
     # Run the checker
     if [ $? -eq 0 ]; then
@@ -131,7 +198,17 @@ elif [ "$MODE" == "check" ]; then
             exit 1
         fi
 
-        if [[ "$INPUT_FILE" == *.csv ]]; then
+        if [ -d "$INPUT_FILE" ]; then
+
+            # If a results directory is provided all its schedules are validated in one process
+            echo -e "${CYAN}[REPORT] Validating all results in $INPUT_FILE...${NC}"
+            BATCH_ARGS=(--batch --out=checker_verdicts.csv)
+            if [ $DEBUG -eq 1 ]; then
+                BATCH_ARGS+=(--debug)
+            fi
+            ./checker_mac$EXT "${BATCH_ARGS[@]}" "$INPUT_FILE"
+
+        elif [[ "$INPUT_FILE" == *.csv ]]; then
 
             # If CSV file is provided the report will be updated
             echo -e "${CYAN}[REPORT] Generating Excel report from $INPUT_FILE...${NC}"
@@ -148,6 +225,34 @@ elif [ "$MODE" == "check" ]; then
         exit 1
     fi
     
+elif [ "$MODE" == "gen" ]; then
+
+    # Compile the generator
+    echo -e "${CYAN}[BUILD] Compiling DFG generator...${NC}"
+    echo ""
+    g++ -std=c++17 -O3 -I. DFGGen.cpp ReadInputs.cpp -o dfggen
+
+    if [ $? -eq 0 ]; then
+        ./dfggen$EXT "${@:2}"
+    else
+        echo -e "${RED}[ERROR] Generator compilation failed.${NC}"
+        exit 1
+    fi
+
+elif [ "$MODE" == "bench" ]; then
+
+    # Compile the benchmarks
+    echo -e "${CYAN}[BUILD] Compiling benchmarks...${NC}"
+    echo ""
+    g++ -std=c++17 -O3 -pthread -I. Bench.cpp LS.cpp FDS.cpp LowerBound.cpp ReadInputs.cpp Verify.cpp Trace.cpp Perf.cpp -o bench
+
+    if [ $? -eq 0 ]; then
+        ./bench$EXT "${@:2}"
+    else
+        echo -e "${RED}[ERROR] Benchmark compilation failed.${NC}"
+        exit 1
+    fi
+
 else
     echo -e "${RED}[ERROR] Invalid mode. Use -h or --help for usage information.${NC}"
     exit 1
@@ -61,7 +61,8 @@ def load_results_from_folder(folder_path):
             cols_map = {}
             for c in df.columns:
                 if "Actual_Latency" in c: cols_map[c] = "Latency"
-                elif "Runtime" in c or "time" in c.lower(): cols_map[c] = "Runtime"
+                # first match only: Runtime_ms, not the Runtime_*_ms statistics of --repeat
+                elif ("Runtime" in c or "time" in c.lower()) and "Runtime" not in cols_map.values(): cols_map[c] = "Runtime"
             df = df.rename(columns=cols_map)
             if "Latency" not in df.columns: continue
             if "Runtime" not in df.columns: df["Runtime"] = np.nan